@@ -0,0 +1,179 @@
+#ifndef FuelCalculator_H
+#define FuelCalculator_H
+
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct FuelTotals {
+	// Fuel for the mass of the modules
+	std::int64_t moduleFuel = 0;
+	// Fuel for the modules and for the fuel itself
+	std::int64_t totalFuel = 0;
+
+	FuelTotals &operator+=(const FuelTotals &other) {
+		moduleFuel += other.moduleFuel;
+		totalFuel += other.totalFuel;
+		return *this;
+	}
+};
+
+// Every step divides by 3, so the fuel of a 32 bit mass reaches 0 within 21 steps
+constexpr int MaxFuelSteps = 21;
+
+// Masses per kernel call
+constexpr std::size_t KernelBlock = 4096;
+
+// Vectorized over the masses of a block, one 32 bit lane per mass. The block
+// always has KernelBlock masses, padded with zeros (which need no fuel), and
+// the fuel-for-fuel steps are fully unrolled with no early exit: fixed trip
+// counts let the compiler vectorize at -O2 too. Checked with -fopt-info-vec.
+inline FuelTotals FuelKernel(const std::uint32_t (&mass)[KernelBlock], const std::size_t count) {
+	std::uint64_t thirds = 0;
+	std::uint64_t totalFuel = 0;
+
+	for (std::size_t i = 0; i < KernelBlock; ++i) {
+		std::uint32_t fuel = mass[i] / 3;
+		thirds += fuel;
+
+		// Less than half of the mass, so it fits the lane
+		std::uint32_t laneFuel = 0;
+#pragma GCC unroll 21
+		for (int step = 0; step < MaxFuelSteps; ++step) {
+			fuel = fuel > 2 ? fuel - 2 : 0;
+			laneFuel += fuel;
+			fuel /= 3;
+		}
+		totalFuel += laneFuel;
+	}
+
+	// Only the real masses take the 2 off, even when it goes negative
+	return {static_cast<std::int64_t>(thirds) - 2 * static_cast<std::int64_t>(count), static_cast<std::int64_t>(totalFuel)};
+}
+
+// Parses the whitespace separated masses in [begin, end) in blocks and runs the kernel on each block
+inline FuelTotals ManifestFuel(const char *begin, const char *const end) {
+	std::uint32_t block[KernelBlock];
+	std::size_t count = 0;
+	FuelTotals result;
+
+	while (true) {
+		while (begin != end && (*begin == '\n' || *begin == ' ' || *begin == '\r' || *begin == '\t')) {
+			++begin;
+		}
+		if (begin == end) {
+			break;
+		}
+
+		const auto [next, error] = std::from_chars(begin, end, block[count]);
+		if (error != std::errc{}) {
+			throw std::runtime_error("Bad module mass: " + std::string(begin, std::find(begin, end, '\n')));
+		}
+		begin = next;
+
+		if (++count == KernelBlock) {
+			result += FuelKernel(block, count);
+			count = 0;
+		}
+	}
+
+	std::fill(block + count, block + KernelBlock, 0);
+	return result += FuelKernel(block, count);
+}
+
+// Splits the manifest on line boundaries and reduces the fuel of each part in parallel
+inline FuelTotals ManifestFuel(const char *begin, const char *const end, unsigned threads) {
+	const auto size = static_cast<std::size_t>(end - begin);
+	threads = std::max(1u, std::min<unsigned>(threads, size / (1 << 16) + 1));
+
+	std::vector<std::future<FuelTotals>> parts;
+	const char *partBegin = begin;
+	for (unsigned t = 1; t < threads; ++t) {
+		const char *partEnd = std::find(std::max(partBegin, begin + size * t / threads), end, '\n');
+		parts.push_back(std::async(std::launch::async, [=] { return ManifestFuel(partBegin, partEnd); }));
+		partBegin = partEnd;
+	}
+
+	auto result = ManifestFuel(partBegin, end);
+	for (auto &part : parts) {
+		result += part.get();
+	}
+
+	return result;
+}
+
+// The whole input, memory mapped when it is a regular file and read otherwise (e.g. from a pipe)
+class Manifest {
+	const char *data = nullptr;
+	std::size_t size = 0;
+	bool mapped = false;
+	std::string buffer;
+
+public:
+	explicit Manifest(const int fd) {
+		struct stat info;
+		if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+			void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (address != MAP_FAILED) {
+				madvise(address, info.st_size, MADV_SEQUENTIAL);
+				data = static_cast<const char *>(address);
+				size = info.st_size;
+				mapped = true;
+				return;
+			}
+		}
+
+		char chunk[1 << 16];
+		while (true) {
+			const ssize_t n = read(fd, chunk, sizeof(chunk));
+			if (n == 0) {
+				break;
+			}
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::runtime_error(std::string("Failed to read the manifest: ") + std::strerror(errno));
+			}
+			buffer.append(chunk, n);
+		}
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	explicit Manifest(std::string &&contents)
+		: buffer(std::move(contents))
+	{
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	Manifest(const Manifest &) = delete;
+	Manifest &operator=(const Manifest &) = delete;
+
+	~Manifest() {
+		if (mapped) {
+			munmap(const_cast<char *>(data), size);
+		}
+	}
+
+	FuelTotals Fuel(const unsigned threads = std::max(1u, std::thread::hardware_concurrency())) const {
+		return ManifestFuel(data, data + size, threads);
+	}
+};
+
+#endif
@@ -6,6 +6,9 @@
 #include <numeric>
 #include <map>
 #include <algorithm>
+#include <string>
+
+#include "FuelCalculator.h"
 
 long ModuleFuel(long mass){
 	return (mass / 3) - 2;
@@ -41,12 +44,23 @@ int main(int argc, char* argv[] ){
 		}
 	}
 
-	long fuelRequirement = std::transform_reduce(
-		std::istream_iterator<long>(std::cin),
-		std::istream_iterator<long>(),
-		0,
-		std::plus<long>(),
-		TotalFuel);
+	// The batch calculator has to agree with the recursive rule
+	std::string manifest;
+	long expected = 0;
+	for (long mass = 1; mass < 400000; mass += 7) {
+		manifest += std::to_string(mass * 10007 % 4000000000) + '\n';
+		expected += TotalFuel(mass * 10007 % 4000000000);
+	}
+	for (const unsigned threads : {1u, 4u}) {
+		const auto computed = ManifestFuel(manifest.data(), manifest.data() + manifest.size(), threads);
+		if (computed.totalFuel != expected) {
+			std::cerr << "Failed batch fuel on " << threads << " threads, computed: " << computed.totalFuel
+					  << " expected: " << expected << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const long fuelRequirement = Manifest(STDIN_FILENO).Fuel().totalFuel;
 
 	if (std::any_of(std::cbegin(badResults), std::cend(badResults), [&fuelRequirement](const auto &value) { return value == fuelRequirement; })) {
 		std::cerr << "Bad Result: " << fuelRequirement << std::endl;
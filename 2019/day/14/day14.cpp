@@ -5,9 +5,13 @@
 #include <iterator>
 #include <vector>
 #include <algorithm>
-#include <regex>
 #include <optional>
 #include <utility>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
 
 
 struct Chemical {
@@ -42,203 +46,444 @@ struct Reaction {
 
 typedef std::vector<Reaction> Reactions;
 
-Chemical ParseChemical(const std::string &input){
-	Chemical result;
-	std::istringstream ss(input);
-	if(ss.peek() == ','){
-		ss.ignore(1);
+// Largest fuel amount or ore budget the solver accepts
+constexpr long long MaxQuantity = 1ll << 62;
+
+// Single pass tokenizer for reaction lists like
+// 7 A, 1 B => 1 C
+// 2 AB, 3 BC, 4 CA => 1 FUEL
+class ReactionReader {
+	const char *pos;
+	const char *const end;
+
+	[[noreturn]] void Error(const std::string &what) const {
+		const auto lineEnd = std::find(pos, end, '\n');
+		throw std::runtime_error(what + " at: \"" + std::string(pos, lineEnd) + "\"");
 	}
-	ss >> result.quantity;
-	if(!ss) goto prod_error;
 
-	if(ss.get() != ' ') goto prod_error;
+	void SkipSpaces() {
+		while(pos != end && (*pos == ' ' || *pos == '\r')){
+			++pos;
+		}
+	}
 
-	ss >> result.element;
-	if(!ss) goto prod_error;
+	Chemical ReadChemical() {
+		SkipSpaces();
+		if(pos == end || *pos < '0' || *pos > '9'){
+			Error("Expected a quantity");
+		}
 
-	return result;
+		Chemical result{{}, 0};
+		for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos){
+			const int digit = *pos - '0';
+			// Checked before the multiplication, which would overflow first
+			if(result.quantity > (MaxQuantity - digit) / 10){
+				Error("Quantity too large");
+			}
+			result.quantity = result.quantity * 10 + digit;
+		}
+		if(result.quantity == 0){
+			Error("Quantity can't be zero");
+		}
 
-prod_error:
-	throw std::runtime_error("Invalid Chemical input: " + input);
-}
+		if(pos == end || *pos != ' '){
+			Error("Expected a space");
+		}
+		++pos;
 
-std::optional<Reaction> ParseReaction(const std::string &line){
-	if(line.size() == 0){
-		return std::nullopt;
+		const auto nameBegin = pos;
+		while(pos != end && *pos >= 'A' && *pos <= 'Z'){
+			++pos;
+		}
+		if(nameBegin == pos){
+			Error("Expected an element name");
+		}
+		result.element.assign(nameBegin, pos);
+
+		return result;
 	}
-	// 7 A, 1 B => 1 C
-	// 2 AB, 3 BC, 4 CA => 1 FUEL
-	const std::regex itemRx{R"(\d+ [A-Z]+)"};
-	const std::regex reactRx{R"(^((,? ?\d+ [A-Z]+)+) => (\d+ [A-Z]+)$)"};
-	std::smatch match;
 
-	if(!std::regex_match(line, match, reactRx)){
-		std::cerr << "Couldn't match line: " << line << std::endl;
-		return std::nullopt;
+public:
+	ReactionReader(const char *begin, const char *end)
+		: pos(begin)
+		, end(end)
+	{
 	}
-	if(match.size() != 4){
-		std::cerr << "Bad number of matches (" << match.size() << ") for " << line << std::endl;
-		return std::nullopt;
+
+	// Skips blank lines, returns true when there are no more reactions
+	bool AtEnd() {
+		while(pos != end && (*pos == ' ' || *pos == '\r' || *pos == '\n')){
+			++pos;
+		}
+		return pos == end;
 	}
 
-	Reaction result;
+	Reaction Next() {
+		Reaction result;
+
+		for(;;){
+			result.input.push_back(ReadChemical());
+			SkipSpaces();
+			if(pos != end && *pos == ','){
+				++pos;
+				continue;
+			}
+			if(end - pos >= 2 && pos[0] == '=' && pos[1] == '>'){
+				pos += 2;
+				break;
+			}
+			Error("Expected ',' or '=>'");
+		}
+
+		result.output = ReadChemical();
+		SkipSpaces();
+		if(pos != end && *pos != '\n'){
+			Error("Expected the end of the line");
+		}
 
-	auto iter = std::sregex_iterator(match[1].first, match[1].second, itemRx);
-	for(;iter != std::sregex_iterator(); ++iter){
-		result.input.push_back(ParseChemical(iter->str()));
+		return result;
 	}
+};
 
-	result.output = ParseChemical(match[3].str());
+std::optional<Reaction> ParseReaction(const std::string &line){
+	ReactionReader reader(line.data(), line.data() + line.size());
+	if(reader.AtEnd()){
+		return std::nullopt;
+	}
 
-	return result;
+	try {
+		auto result = reader.Next();
+		if(!reader.AtEnd()){
+			std::cerr << "Trailing input after the reaction: " << line << std::endl;
+			return std::nullopt;
+		}
+		return result;
+	}
+	catch(const std::runtime_error &e) {
+		std::cerr << e.what() << std::endl;
+		return std::nullopt;
+	}
 }
 
-Reactions ParseInput(std::istream &&is){
+Reactions ParseInput(const std::string &input){
 	Reactions result;
 
-	while (is) {
-		std::string line;
-		std::getline(is, line);
-		if(const auto r = ParseReaction(line); r.has_value()){
-			result.push_back(r.value());
-		}
+	ReactionReader reader(input.data(), input.data() + input.size());
+	while(!reader.AtEnd()){
+		result.push_back(reader.Next());
 	}
 
 	return result;
 }
 
-Reactions ParseInput(const std::string &input){
-	return ParseInput(std::istringstream{input});
+Reactions ParseInput(std::istream &&is){
+	return ParseInput(std::string{
+		std::istreambuf_iterator<char>(is),
+		std::istreambuf_iterator<char>()});
 }
 
 
-long long OreRequirement(const Chemical &target, const Reactions &reactions) {
-	// std::map<std::string, BufferEntry> buffer;
-
-	// buffer[target.element].reserved += target.quantity;
-	// return Produce(target, reactions, buffer, log);
-	Chemical ore{"ORE", 0};
+typedef std::size_t ChemicalId;
 
-	std::deque<Chemical> requirements;
-	std::vector<Chemical> extra;
+// The reactions compiled into a DAG over interned chemical ids. Ids are handed
+// out in topological order (a chemical always comes before the chemicals it is
+// made from), so the demand of a query is settled with a single forward pass.
+struct ReactionGraph {
+	struct Input {
+		ChemicalId id;
+		long long quantity;
+	};
 
-	requirements.emplace_back(target);
+	std::map<std::string, ChemicalId> ids;
+	std::vector<std::string> names;
+	// Output quantity of the reaction producing each chemical, 0 for ORE
+	std::vector<long long> produced;
+	// The inputs of chemical id are inputs[inputsBegin[id], inputsBegin[id + 1])
+	std::vector<std::size_t> inputsBegin;
+	std::vector<Input> inputs;
+	ChemicalId ore;
+	// Scratch space, reused by every query
+	std::vector<long long> demand;
+
+	ChemicalId Find(const std::string &element) const {
+		const auto iter = ids.find(element);
+		if(iter == ids.cend()){
+			throw std::runtime_error("Unknown chemical: " + element);
+		}
+		return iter->second;
+	}
 
-	//const auto notOre = [](const auto &ch) { return ch.element != "ORE"; };
+	// Saturates at std::numeric_limits<long long>::max()
+	long long Ore(const ChemicalId target, const long long quantity) {
+		std::fill(demand.begin(), demand.end(), 0);
+		demand[target] = quantity;
 
-	while (requirements.size())
-	{
-		// select element
-		const auto current = requirements.front();
-		requirements.pop_front();
-
-		long long toProduce = current.quantity;
-
-		// consume extra
-		const auto extraIter = std::find_if(extra.begin(), extra.end(), [&](const auto &e) {
-			return e.element == current.element;
-		});
-		if(extraIter != extra.end()){
-			if(extraIter->quantity >= toProduce){
-				extraIter->quantity -= toProduce;
+		for(ChemicalId id = 0; id < demand.size(); ++id){
+			if(!demand[id] || !produced[id]){
 				continue;
 			}
-			else{
-				toProduce -= extraIter->quantity;
-				extraIter->quantity = 0;
+
+			const long long multiplier = demand[id] / produced[id] + (demand[id] % produced[id] ? 1 : 0);
+			for(auto i = inputsBegin[id]; i != inputsBegin[id + 1]; ++i){
+				// Saturate instead of overflowing, anything that large is over budget anyway
+				auto &d = demand[inputs[i].id];
+				long long amount;
+				if(__builtin_mul_overflow(inputs[i].quantity, multiplier, &amount) || __builtin_add_overflow(d, amount, &d)){
+					d = std::numeric_limits<long long>::max();
+				}
 			}
 		}
 
-		// find reaction
-		const auto reaction = *std::find_if(reactions.cbegin(), reactions.cend(), [&](const auto &r){
-			return r.output.element == current.element;
-		});
+		return demand[ore];
+	}
+};
 
-		long long multiplier = (toProduce / reaction.output.quantity) + (toProduce % reaction.output.quantity ? 1 : 0);
+ReactionGraph Compile(const Reactions &reactions) {
+	// Intern the names in order of appearance
+	std::map<std::string, ChemicalId> interned;
+	std::vector<const Reaction *> producer;
+	const auto intern = [&](const std::string &element) {
+		const auto [iter, inserted] = interned.emplace(element, interned.size());
+		if(inserted){
+			producer.push_back(nullptr);
+		}
+		return iter->second;
+	};
 
-		for( const auto &input: reaction.input){
-			if(input.element == ore.element){
-				ore.quantity += input.quantity * multiplier;
-				continue;
-			}
+	intern("ORE");
+	for(const auto &r : reactions){
+		auto &p = producer[intern(r.output.element)];
+		if(p){
+			throw std::runtime_error("Multiple reactions produce " + r.output.element);
+		}
+		p = &r;
+		for(const auto &i : r.input){
+			intern(i.element);
+		}
+	}
 
-			// not ore;
-			auto iter = std::find_if(requirements.begin(), requirements.end(), [&](const auto &ch){
-				return ch.element == input.element;
-			});
+	// Count the consumers of each chemical and sort with Kahn's algorithm,
+	// starting from the chemicals nobody consumes
+	std::vector<std::string> names(interned.size());
+	std::vector<std::size_t> consumers(interned.size(), 0);
+	for(const auto &[name, id] : interned){
+		names[id] = name;
+		if(!producer[id] && name != "ORE"){
+			throw std::runtime_error("No reaction produces " + name);
+		}
+	}
+	for(const auto &r : reactions){
+		for(const auto &i : r.input){
+			++consumers[interned[i.element]];
+		}
+	}
 
-			if(iter != requirements.end()){
-				iter->quantity += input.quantity * multiplier;
-			}
-			else{
-				requirements.emplace_back(Chemical{input.element, input.quantity * multiplier});
+	std::vector<ChemicalId> order;
+	order.reserve(interned.size());
+	for(ChemicalId id = 0; id < consumers.size(); ++id){
+		if(!consumers[id]){
+			order.push_back(id);
+		}
+	}
+	for(std::size_t next = 0; next < order.size(); ++next){
+		if(const auto *r = producer[order[next]]; r){
+			for(const auto &i : r->input){
+				const auto id = interned[i.element];
+				if(!--consumers[id]){
+					order.push_back(id);
+				}
 			}
 		}
+	}
+	if(order.size() != interned.size()){
+		throw std::runtime_error("The reactions contain a cycle");
+	}
 
-		long long remaining = reaction.output.quantity * multiplier - toProduce;
-		if(remaining){
-			if(extraIter != extra.end()){
-				extraIter->quantity += remaining;
-			}
-			else{
-				extra.emplace_back(Chemical{current.element, remaining});
-			}
+	// Renumber in topological order and lay the inputs out contiguously
+	std::vector<ChemicalId> rank(order.size());
+	for(std::size_t i = 0; i < order.size(); ++i){
+		rank[order[i]] = i;
+	}
 
+	ReactionGraph result;
+	result.names.reserve(order.size());
+	result.produced.reserve(order.size());
+	result.inputsBegin.reserve(order.size() + 1);
+	for(const auto old : order){
+		result.ids[names[old]] = result.names.size();
+		result.names.push_back(names[old]);
+		result.inputsBegin.push_back(result.inputs.size());
+
+		const auto *r = producer[old];
+		result.produced.push_back(r ? r->output.quantity : 0);
+		if(r){
+			for(const auto &i : r->input){
+				result.inputs.push_back({rank[interned[i.element]], i.quantity});
+			}
 		}
-
 	}
+	result.inputsBegin.push_back(result.inputs.size());
+	result.ore = rank[interned["ORE"]];
+	result.demand.resize(order.size());
 
-	return ore.quantity;
+	return result;
 }
 
-long long FuelFromTrillionOre(const Reactions &reactions)
-{
-	long long maxOre = 1000000000000ll;
+long long OreRequirement(const Chemical &target, ReactionGraph &graph) {
+	return graph.Ore(graph.Find(target.element), target.quantity);
+}
 
-	auto calculateOre = [&](const auto target) {
-		return OreRequirement({"FUEL", target}, reactions);
-	};
+long long OreRequirement(const Chemical &target, const Reactions &reactions) {
+	auto graph = Compile(reactions);
+	return OreRequirement(target, graph);
+}
 
-	// find min-max
+// Answers fuel -> ore and ore -> fuel queries against a graph compiled once.
+// Every probe is memoized, so the queries of a batch narrow each other down.
+class OreSolver {
+	ReactionGraph graph;
+	ChemicalId fuel;
+	long long orePerFuel;
+	// Ore per fuel when no batch has to be rounded up, a lower bound of the
+	// marginal cost of each fuel
+	long double linearOrePerFuel;
+	std::map<long long, long long> probes;
+
+	long double LinearOrePerFuel() const {
+		std::vector<long double> demand(graph.names.size(), 0);
+		demand[fuel] = 1;
+
+		for(ChemicalId id = 0; id < demand.size(); ++id){
+			if(!graph.produced[id]){
+				continue;
+			}
+			const auto multiplier = demand[id] / graph.produced[id];
+			for(auto i = graph.inputsBegin[id]; i != graph.inputsBegin[id + 1]; ++i){
+				demand[graph.inputs[i].id] += graph.inputs[i].quantity * multiplier;
+			}
+		}
 
-	long long min = 1;
-	long long max = 1;
-	while(calculateOre(max<<=1) < maxOre)
-	{
-		min = max;
+		return demand[graph.ore];
 	}
 
-	// search between min-max
-	while (min != max) {
-		auto target = (min + max)/2;
-		auto oreAmount = calculateOre(target);
-
-		if (oreAmount == maxOre){
-			return target;
+	long long Probe(const long long fuelAmount) {
+		if(const auto iter = probes.find(fuelAmount); iter != probes.cend()){
+			return iter->second;
 		}
-		else if (oreAmount < maxOre)
-		{
-			min = target;
-		}
-		else {
-			max = target;
-		}
-		if(max - min == 1){
-			break;
+		const auto ore = graph.Ore(fuel, fuelAmount);
+		probes.emplace(fuelAmount, ore);
+		return ore;
+	}
+
+public:
+	explicit OreSolver(const Reactions &reactions)
+		: graph(Compile(reactions))
+		, fuel(graph.Find("FUEL"))
+		, orePerFuel(graph.Ore(fuel, 1))
+		, linearOrePerFuel(LinearOrePerFuel())
+	{
+		if(!orePerFuel){
+			throw std::runtime_error("FUEL doesn't need any ORE");
 		}
+		probes.emplace(0, 0);
+		probes.emplace(1, orePerFuel);
 	}
 
-	return min;
-}
+	explicit OreSolver(const std::string &input)
+		: OreSolver(ParseInput(input))
+	{
+	}
 
+	std::size_t ProbeCount() const {
+		return probes.size();
+	}
 
+	long long Ore(const long long fuelAmount) {
+		if(fuelAmount < 0 || fuelAmount > MaxQuantity){
+			throw std::domain_error("Fuel amount out of range: " + std::to_string(fuelAmount));
+		}
+		return Probe(fuelAmount);
+	}
+
+	// Most fuel that can be produced with the given ore
+	long long Fuel(const long long oreBudget) {
+		if(oreBudget < 0 || oreBudget > MaxQuantity){
+			throw std::domain_error("Ore budget out of range: " + std::to_string(oreBudget));
+		}
 
+		// Ore(k) <= k * Ore(1), so lo is always affordable. The estimate from
+		// the linear ratio is at most a few batches off the answer.
+		long long lo = oreBudget / orePerFuel;
+		long long hi = MaxQuantity + 1;
 
+		// Tighten with what earlier queries already probed
+		if(auto iter = probes.upper_bound(lo); iter != probes.cend()){
+			for(; iter != probes.cend() && iter->second <= oreBudget; ++iter){
+				lo = iter->first;
+			}
+			if(iter != probes.cend()){
+				hi = iter->first;
+			}
+		}
+
+		// With more than one fuel per ore the ratio can go past long long
+		const auto linearFuel = std::floor(oreBudget / linearOrePerFuel);
+		const auto estimate = linearFuel < static_cast<long double>(std::numeric_limits<long long>::max())
+			? static_cast<long long>(linearFuel)
+			: std::numeric_limits<long long>::max();
+		long long guess = std::clamp(estimate, lo, hi - 1);
+
+		// Gallop away from the guess until the answer is bracketed
+		for(long long step = 1; hi - lo > 1; step *= 2){
+			if(guess <= lo || guess >= hi){
+				break;
+			}
+			if(Probe(guess) <= oreBudget){
+				lo = guess;
+				guess = (hi - guess > step) ? guess + step : hi;
+			}
+			else {
+				hi = guess;
+				guess = (guess - lo > step) ? guess - step : lo;
+			}
+		}
 
+		while(hi - lo > 1){
+			const auto mid = lo + (hi - lo) / 2;
+			if(Probe(mid) <= oreBudget){
+				lo = mid;
+			}
+			else {
+				hi = mid;
+			}
+		}
 
+		return lo;
+	}
 
+	std::vector<long long> Ore(const std::vector<long long> &fuelAmounts) {
+		std::vector<long long> result;
+		result.reserve(fuelAmounts.size());
+		for(const auto f : fuelAmounts){
+			result.push_back(Ore(f));
+		}
+		return result;
+	}
 
+	std::vector<long long> Fuel(const std::vector<long long> &oreBudgets) {
+		std::vector<long long> result;
+		result.reserve(oreBudgets.size());
+		for(const auto b : oreBudgets){
+			result.push_back(Fuel(b));
+		}
+		return result;
+	}
+};
 
+long long FuelFromTrillionOre(const Reactions &reactions)
+{
+	return OreSolver{reactions}.Fuel(1000000000000ll);
+}
 
 bool Test(){
 	if (not ParseReaction("10 ORE => 10 A").has_value()){
@@ -364,6 +609,55 @@ bool Test(){
 		return false;
 	}
 
+	auto graph5 = Compile(input5);
+	if (graph5.names.front() != "FUEL" || graph5.names.back() != "ORE") {
+		std::cerr << "Bad topological order for graph5." << std::endl;
+		return false;
+	}
+	if (const auto ore = OreRequirement({"FUEL", fuel5}, graph5); ore > 1000000000000ll) {
+		std::cerr << "Bad graph5 ore " << ore << " for " << fuel5 << " fuel." << std::endl;
+		return false;
+	}
+
+	OreSolver solver5{input5};
+	const auto fuels5 = solver5.Fuel({1000000000000ll, 2210736, 2210735, 0, MaxQuantity});
+	if (fuels5[0] != 460664 || fuels5[1] != 1 || fuels5[2] != 0 || fuels5[3] != 0) {
+		std::cerr << "Bad batch fuel for input5." << std::endl;
+		return false;
+	}
+	if (const auto ores = solver5.Ore({fuels5[4], fuels5[4] + 1}); ores[0] > MaxQuantity || ores[1] <= MaxQuantity) {
+		std::cerr << "Bad fuel " << fuels5[4] << " for an ore budget of 2^62." << std::endl;
+		return false;
+	}
+	if (solver5.ProbeCount() > 200) {
+		std::cerr << "Too many probes for the input5 batch: " << solver5.ProbeCount() << std::endl;
+		return false;
+	}
+
+	if (const auto fuel = OreSolver{"1 ORE => 10 FUEL"}.Fuel(MaxQuantity); fuel != MaxQuantity) {
+		std::cerr << "Bad fuel " << fuel << " for 10 fuel per ore." << std::endl;
+		return false;
+	}
+
+	// ParseInput throws where ParseReaction would print the error
+	for (const auto malformed : {"7 A, 1 B = 1 C", "7 A 1 B => 1 C", "A => 1 C", "46116860184273879049 ORE => 1 FUEL", "0 ORE => 1 FUEL", "1 ORE => 0 FUEL"}) {
+		try {
+			ParseInput(malformed);
+			std::cerr << "Malformed reaction was accepted: " << malformed << std::endl;
+			return false;
+		}
+		catch (const std::runtime_error &) {
+		}
+	}
+
+	try {
+		Compile(ParseInput("1 A => 1 B\n1 B => 1 A\n1 B => 1 FUEL"));
+		std::cerr << "Cyclic reactions were accepted." << std::endl;
+		return false;
+	}
+	catch (const std::runtime_error &) {
+	}
+
 	return true;
 }
 
@@ -380,11 +674,11 @@ int main(int, const char **)
 		std::istreambuf_iterator<char>(std::cin),
 		std::istreambuf_iterator<char>()};
 
-	const auto reactions = ParseInput(input);
+	OreSolver solver{input};
 
-	std::cout << "First " << OreRequirement({"FUEL", 1}, reactions) << std::endl;
+	std::cout << "First " << solver.Ore(1) << std::endl;
 
-	std::cout << "Second " << FuelFromTrillionOre(reactions) << std::endl;
+	std::cout << "Second " << solver.Fuel(1000000000000ll) << std::endl;
 
 	return EXIT_SUCCESS;
 }
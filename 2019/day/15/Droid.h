@@ -13,6 +13,8 @@
 #include <stack>
 #include <vector>
 
+#include <unistd.h>
+
 
 template <typename T>
 std::ostream& operator<<(std::ostream& os, const Point<T> &p){
@@ -192,6 +194,10 @@ public:
 	}
 
 	void RenderMap() const{
+		// The map is an animation, skip it when the output isn't watched
+		if(!isatty(STDOUT_FILENO)){
+			return;
+		}
 		std::cout << "\033[2J\033[1;1H";
 
 		Point<long long> minP = {};
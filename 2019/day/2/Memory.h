@@ -5,6 +5,7 @@
 #include <ostream>
 #include <optional>
 #include <iostream>
+#include <cstring>
 
 class Memory
 {
@@ -41,35 +42,43 @@ public:
 		return data.size();
 	}
 
-	bool Execute() {
-		for (std::vector<int>::size_type pc = 0; (*this)[pc] != 99 ; pc += 4) {
-
-			const auto &opcode = (*this)[pc];
-
-			int (*op)(int v1, int v4);
+	// Copies the contents of a memory of the same size without reallocating
+	void Reset(const Memory &pristine) {
+		if (data.size() != pristine.data.size()) {
+			data = pristine.data;
+			return;
+		}
+		std::memcpy(data.data(), pristine.data.data(), data.size() * sizeof(int));
+	}
 
-			switch (opcode) {
-			case 1:
-				op = [](const int v1, const int v2) -> int {return v1 + v2; };
-				break;
+	bool Execute(const bool reportErrors = true) {
+		int *const memory = data.data();
+		const size_t size = data.size();
+		const auto valid = [size](const int address) {
+			return address >= 0 && static_cast<size_t>(address) < size;
+		};
 
-			case 2:
-				op = [](const int v1, const int v2) -> int { return v1 * v2; };
-				break;
+		for (size_t pc = 0; pc < size && memory[pc] != 99; pc += 4) {
+			const int opcode = memory[pc];
 
-			default:
-				std::cerr << "Bad Opcode [" << opcode << "] at position " << pc << std::endl;
+			if (opcode != 1 && opcode != 2) {
+				if (reportErrors) {
+					std::cerr << "Bad Opcode [" << opcode << "] at position " << pc << std::endl;
+				}
 				return false;
 			}
 
-			const int p1 = (*this)[pc + 1];
-			const int p2 = (*this)[pc + 2];
-			const int to = (*this)[pc + 3];
-
-			const int v1 = (*this)[p1];
-			const int v2 = (*this)[p2];
+			if (pc + 3 >= size || !valid(memory[pc + 1]) || !valid(memory[pc + 2]) || !valid(memory[pc + 3])) {
+				if (reportErrors) {
+					std::cerr << "Bad address for the instruction at position " << pc << std::endl;
+				}
+				return false;
+			}
 
-			(*this)[to] = op(v1, v2);
+			// Wrap around on overflow, as unsigned arithmetic does
+			const unsigned v1 = memory[memory[pc + 1]];
+			const unsigned v2 = memory[memory[pc + 2]];
+			memory[memory[pc + 3]] = static_cast<int>(opcode == 1 ? v1 + v2 : v1 * v2);
 		}
 
 		return true;
@@ -0,0 +1,81 @@
+#ifndef NounVerbSweep_H
+#define NounVerbSweep_H
+
+#include "Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct NounVerb {
+	int noun;
+	int verb;
+};
+
+// Searches noun in [0, maxNoun] and verb in [0, maxVerb] for the first pair,
+// in noun-major order, that leaves target at position 0.
+//
+// Each worker owns one Memory, resets it from the pristine program for every
+// attempt, and takes every threads-th candidate. As soon as a worker finds a
+// match the others stop once they pass its position, so the result is the same
+// for any number of threads.
+inline std::optional<NounVerb> FindNounVerb(
+	const Memory &program,
+	const int target,
+	const int maxNoun = 99,
+	const int maxVerb = 99,
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+{
+	if (program.size() < 3 || maxNoun < 0 || maxVerb < 0) {
+		return std::nullopt;
+	}
+
+	const long long verbs = static_cast<long long>(maxVerb) + 1;
+	const long long candidates = (static_cast<long long>(maxNoun) + 1) * verbs;
+	threads = static_cast<unsigned>(std::min<long long>(std::max(1u, threads), candidates));
+
+	constexpr auto NotFound = std::numeric_limits<long long>::max();
+	std::atomic<long long> found{NotFound};
+
+	const auto worker = [&](const unsigned first) {
+		Memory memory{program};
+
+		for (long long candidate = first; candidate < candidates; candidate += threads) {
+			if (candidate > found.load(std::memory_order_relaxed)) {
+				return;
+			}
+
+			memory.Reset(program);
+			memory[1] = static_cast<int>(candidate / verbs);
+			memory[2] = static_cast<int>(candidate % verbs);
+
+			if (memory.Execute(false) && memory[0] == target) {
+				// Keep the earliest match
+				auto current = found.load();
+				while (candidate < current && !found.compare_exchange_weak(current, candidate)) {
+				}
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned t = 1; t < threads; ++t) {
+		workers.emplace_back(worker, t);
+	}
+	worker(0);
+	for (auto &w : workers) {
+		w.join();
+	}
+
+	const auto result = found.load();
+	if (result == NotFound) {
+		return std::nullopt;
+	}
+	return NounVerb{static_cast<int>(result / verbs), static_cast<int>(result % verbs)};
+}
+
+#endif
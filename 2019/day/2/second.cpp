@@ -1,5 +1,6 @@
 #include "Memory.h"
 #include "TestCase.h"
+#include "NounVerbSweep.h"
 
 int main(const int argc, const char * const argv[]) {
 	if (!TestCase::RunSystemTests()) {
@@ -7,6 +8,21 @@ int main(const int argc, const char * const argv[]) {
 		return EXIT_FAILURE;
 	}
 
+	// memory[0] = memory[noun] + memory[verb], with noun and verb past the end of the program
+	// for most of the range, which the sweep has to skip
+	const Memory sweepTest{1, 0, 0, 0, 99, 10, 20, 30, 40};
+	for (const unsigned threads : {1u, 3u}) {
+		const auto found = FindNounVerb(sweepTest, 70, 1000, 1000, threads);
+		if (!found || found->noun != 7 || found->verb != 8) {
+			std::cerr << "Sweep on " << threads << " threads failed." << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (FindNounVerb(sweepTest, 1000, 1000, 1000, threads)) {
+			std::cerr << "Sweep on " << threads << " threads found an impossible target." << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
 	auto input = Memory::ReadFromInput();
 	if(!input.has_value()){
 		std::cerr << "Failed to read the input." << std::endl;
@@ -14,22 +30,12 @@ int main(const int argc, const char * const argv[]) {
 	}
 
 
-	for(int noun = 0; ; ++noun){
-		for(int verb = 0; verb <= noun; ++verb) {
-
-			auto memory{input.value()};
-			memory[1] = noun;
-			memory[2] = verb;
-
-			if (!memory.Execute())
-			{
-				return EXIT_FAILURE;
-			}
-			if (memory[0] == 19690720){
-				int result = 100 * noun + verb;
-				std::cout << "Answer: " << result << std::endl;
-				return EXIT_SUCCESS;
-			}
-		}
+	const auto result = FindNounVerb(input.value(), 19690720);
+	if (!result) {
+		std::cerr << "No noun and verb produce the target." << std::endl;
+		return EXIT_FAILURE;
 	}
+
+	std::cout << "Answer: " << 100 * result->noun + result->verb << std::endl;
+	return EXIT_SUCCESS;
 }
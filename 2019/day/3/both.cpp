@@ -10,6 +10,7 @@
 #include <sstream>
 #include <unordered_set>
 #include <optional>
+#include <cctype>
 
 enum class Direction {
 	Up,
@@ -49,12 +50,12 @@ struct Point {
 	int x;
 	int y;
 
-	auto step(const Direction &d) const {
+	auto step(const Direction &d, const int distance = 1) const {
 		switch (d) {
-		case Direction::Up: return Point{ x, y + 1 };
-		case Direction::Down: return Point{ x, y - 1 };
-		case Direction::Left: return Point{ x - 1, y };
-		case Direction::Right: return Point{ x + 1, y };
+		case Direction::Up: return Point{ x, y + distance };
+		case Direction::Down: return Point{ x, y - distance };
+		case Direction::Left: return Point{ x - distance, y };
+		case Direction::Right: return Point{ x + distance, y };
 		default:
 			throw std::domain_error("Bad Direction parameter.");
 		}
@@ -206,10 +207,7 @@ auto Render(const std::vector<Instruction> &instructions) {
 	for (const auto &i : instructions) {
 		LineSegment currentSegment{i.direction, i.distance, distanceSum, current};
 
-		// walk the line
-		for (int step = 0; step < i.distance; ++step) {
-			current = current.step(i.direction);
-		}
+		current = current.step(i.direction, i.distance);
 
 		currentSegment.end = current;
 
@@ -318,34 +316,110 @@ std::string Draw(const std::vector<std::vector<LineSegment>> &segmentVectors, st
 	return ss.str();
 }
 
-auto processInput(const std::string &input, int verbose = 0) {
-	const auto brakePos = std::find(std::begin(input), std::end(input), '\n');
-	if (brakePos == std::end(input)) {
-		throw std::runtime_error("No line brake was found in the input.");
-	}
+// Reports every crossing between segments of different wires, except at the
+// origin, by sweeping over x. Horizontal segments are kept in a set ordered by
+// y while the sweep is inside their x range and each vertical segment queries
+// that set for its y range, O((n + m) log n + k) in total.
+std::vector<IntersectionPoint> Intersections(const std::vector<std::vector<LineSegment>> &wires) {
+	struct Entry {
+		size_t wire;
+		const LineSegment *segment;
+	};
 
-	const auto instructions1 = Tokenise(std::string{ std::cbegin(input), brakePos });
-	const auto instructions2 = Tokenise(std::string{ brakePos+1, std::cend(input)});
+	// At the same x, horizontal segments are inserted before and removed after the queries
+	enum class EventKind { Insert, Query, Remove };
 
-	const auto segments1 = Render(instructions1);
-	const auto segments2 = Render(instructions2);
+	struct Event {
+		int x;
+		EventKind kind;
+		size_t index;
 
-	// std::cout << "Segments1: " << segments1 << std::endl;
-	// std::cout << "Segments2: " << segments2 << std::endl;
+		bool operator<(const Event &other) const {
+			return x != other.x ? x < other.x : kind < other.kind;
+		}
+	};
 
-	std::vector<IntersectionPoint> intersections;
+	std::vector<Entry> horizontal;
+	std::vector<Entry> vertical;
+	for (size_t w = 0; w < wires.size(); ++w) {
+		for (const auto &s : wires[w]) {
+			(GetPlane(s.direction) == Plane::Horizontal ? horizontal : vertical).push_back({w, &s});
+		}
+	}
 
-	for (const auto &s1 : segments1) {
-		for (const auto &s2 : segments2) {
-			const auto &p = s1.Intersect(s2);
-			if (p && !(p == Point::Origin)) {
-				intersections.push_back(p.value());
+	std::vector<Event> events;
+	events.reserve(2 * horizontal.size() + vertical.size());
+	for (size_t i = 0; i < horizontal.size(); ++i) {
+		const auto &s = *horizontal[i].segment;
+		events.push_back({std::min(s.begin.x, s.end.x), EventKind::Insert, i});
+		events.push_back({std::max(s.begin.x, s.end.x), EventKind::Remove, i});
+	}
+	for (size_t i = 0; i < vertical.size(); ++i) {
+		events.push_back({vertical[i].segment->begin.x, EventKind::Query, i});
+	}
+	std::sort(events.begin(), events.end());
+
+	typedef std::multimap<int, const Entry *> ActiveSet;
+	ActiveSet active;
+	std::vector<ActiveSet::iterator> positions(horizontal.size());
+	std::vector<IntersectionPoint> result;
+
+	for (const auto &e : events) {
+		switch (e.kind) {
+		case EventKind::Insert:
+			positions[e.index] = active.emplace(horizontal[e.index].segment->begin.y, &horizontal[e.index]);
+			break;
+
+		case EventKind::Remove:
+			active.erase(positions[e.index]);
+			break;
+
+		case EventKind::Query: {
+			const auto &v = vertical[e.index];
+			const auto from = std::min(v.segment->begin.y, v.segment->end.y);
+			const auto to = std::max(v.segment->begin.y, v.segment->end.y);
+
+			for (auto i = active.lower_bound(from); i != active.end() && i->first <= to; ++i) {
+				if (i->second->wire == v.wire) {
+					continue;
+				}
+				const auto p = v.segment->Intersect(*i->second->segment);
+				if (p && !(p.value() == Point::Origin)) {
+					result.push_back(p.value());
+				}
 			}
+			break;
+		}
+		}
+	}
+
+	return result;
+}
+
+std::vector<std::vector<LineSegment>> ParseWires(const std::string &input) {
+	std::vector<std::vector<LineSegment>> result;
+
+	for (auto begin = std::cbegin(input); begin != std::cend(input); ) {
+		const auto end = std::find(begin, std::cend(input), '\n');
+		if (std::any_of(begin, end, [](const char c) { return !std::isspace(static_cast<unsigned char>(c)); })) {
+			result.push_back(Render(Tokenise(std::string{begin, end})));
 		}
+		begin = (end == std::cend(input)) ? end : end + 1;
 	}
 
+	return result;
+}
+
+auto processInput(const std::string &input, int verbose = 0) {
+	const auto wires = ParseWires(input);
+	if (wires.size() < 2) {
+		throw std::runtime_error("At least two wires are needed in the input.");
+	}
+
+	auto intersections = Intersections(wires);
+
 	if (verbose > 1) {
-		std::cout << Draw({segments1, segments2}, intersections);
+		std::cout << Draw(wires, intersections);
 	}
 	if(verbose) std::cout << intersections.size() << " intersections were found." << std::endl;
 	if(intersections.size() == 0) {
@@ -408,6 +482,50 @@ bool test() {
 
 
 
+	// The sweep must agree with checking every pair of segments, also for more than two wires
+	const auto bruteForce = [](const std::vector<std::vector<LineSegment>> &wires) {
+		std::vector<IntersectionPoint> result;
+		for (size_t w1 = 0; w1 < wires.size(); ++w1) {
+			for (size_t w2 = w1 + 1; w2 < wires.size(); ++w2) {
+				for (const auto &s1 : wires[w1]) {
+					for (const auto &s2 : wires[w2]) {
+						const auto &p = s1.Intersect(s2);
+						if (p && !(p == Point::Origin)) {
+							result.push_back(p.value());
+						}
+					}
+				}
+			}
+		}
+		return result;
+	};
+	const auto byPosition = [](const IntersectionPoint &p1, const IntersectionPoint &p2) {
+		return std::make_tuple(p1.x, p1.y, p1.totalDistance) < std::make_tuple(p2.x, p2.y, p2.totalDistance);
+	};
+
+	for (const auto &input : {
+			std::get<2>(testCases[1]),
+			std::get<2>(testCases[2]) + "\nD30,R200,U100,L300,D10",
+			std::string{"R8,U5,L5,D3\nU7,R6,D4,L4\nU3,R10\nR3,U8"}}) {
+		const auto wires = ParseWires(input);
+		auto swept = Intersections(wires);
+		auto expected = bruteForce(wires);
+		std::sort(swept.begin(), swept.end(), byPosition);
+		std::sort(expected.begin(), expected.end(), byPosition);
+
+		if (swept.size() != expected.size() || !std::equal(swept.begin(), swept.end(), expected.begin(), [](const auto &p1, const auto &p2) {
+				return p1 == p2 && p1.totalDistance == p2.totalDistance;
+			})) {
+			std::cerr << "Sweep found " << swept.size() << " intersections, was expecting " << expected.size() << "." << std::endl;
+			return false;
+		}
+	}
+
+	if (const auto result = processInput("R8,U5,L5,D3\nU7,R6,D4,L4\nU1,R10"); result.first != 1 || result.second != 2) {
+		std::cerr << "Bad three wire result of " << result.first << ", " << result.second << " (was expecting: 1, 2)." << std::endl;
+		return false;
+	}
+
 	return success;
 }
 
@@ -0,0 +1,141 @@
+#ifndef PasswordCounter_H
+#define PasswordCounter_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+enum class PairRule {
+	// Two adjacent digits are the same
+	AnyPair,
+	// Two adjacent digits are the same and not part of a larger group
+	ExactPair
+};
+
+// Counts the passwords of a fixed length, with non-decreasing digits and a
+// pair of digits, in a range of values. Leading zeros count as digits.
+//
+// Digit dynamic programming: the values up to a bound are counted by walking
+// the digits of the bound and, for every smaller digit at each position,
+// adding the number of valid completions of the remaining digits from a table
+// built in the constructor.
+class PasswordCounter {
+public:
+	static constexpr int MaxLength = 18;
+
+private:
+	// Digit run state: 0 before the first digit, then the length of the
+	// current run of the same digit, capped at 3
+	static constexpr int RunStates = 4;
+
+	struct State {
+		int last;
+		int run;
+		bool found;
+	};
+
+	const PairRule rule;
+	const int length;
+	std::uint64_t limit;
+	// completions[remaining][last][run][found]
+	std::array<std::array<std::array<std::array<std::uint64_t, 2>, RunStates>, 10>, MaxLength + 1> completions{};
+
+	State Step(const State &s, const int digit) const {
+		State result = s;
+		if (s.run && digit == s.last) {
+			result.run = std::min(s.run + 1, RunStates - 1);
+		}
+		else {
+			result.found = result.found || (rule == PairRule::ExactPair && s.run == 2);
+			result.run = 1;
+		}
+		result.found = result.found || (rule == PairRule::AnyPair && result.run >= 2);
+		result.last = digit;
+
+		return result;
+	}
+
+	bool IsValid(const State &s) const {
+		return s.found || (rule == PairRule::ExactPair && s.run == 2);
+	}
+
+	std::uint64_t Completions(const int remaining, const State &s) const {
+		return completions[remaining][s.last][s.run][s.found];
+	}
+
+	// Valid passwords in [0, value]
+	std::uint64_t CountUpTo(const std::uint64_t value) const {
+		char digits[MaxLength];
+		auto v = value;
+		for (int i = length; i--; v /= 10) {
+			digits[i] = static_cast<char>(v % 10);
+		}
+
+		std::uint64_t result = 0;
+		State s{0, 0, false};
+		for (int i = 0; i < length; ++i) {
+			for (int d = s.last; d < digits[i]; ++d) {
+				result += Completions(length - i - 1, Step(s, d));
+			}
+			if (digits[i] < s.last) {
+				return result;
+			}
+			s = Step(s, digits[i]);
+		}
+
+		return result + (IsValid(s) ? 1 : 0);
+	}
+
+public:
+	PasswordCounter(const PairRule rule, const int length)
+		: rule(rule)
+		, length(length)
+		, limit(1)
+	{
+		if (length < 1 || length > MaxLength) {
+			throw std::domain_error("Unsupported password length " + std::to_string(length));
+		}
+		for (int i = 0; i < length; ++i) {
+			limit *= 10;
+		}
+
+		for (int last = 0; last < 10; ++last) {
+			for (int run = 0; run < RunStates; ++run) {
+				for (int found = 0; found < 2; ++found) {
+					completions[0][last][run][found] = IsValid({last, run, found != 0}) ? 1 : 0;
+				}
+			}
+		}
+
+		for (int remaining = 1; remaining <= length; ++remaining) {
+			for (int last = 0; last < 10; ++last) {
+				for (int run = 0; run < RunStates; ++run) {
+					for (int found = 0; found < 2; ++found) {
+						const State s{last, run, found != 0};
+						std::uint64_t sum = 0;
+						for (int d = last; d < 10; ++d) {
+							sum += Completions(remaining - 1, Step(s, d));
+						}
+						completions[remaining][last][run][found] = sum;
+					}
+				}
+			}
+		}
+	}
+
+	// Valid passwords in [from, to]
+	std::uint64_t Count(const std::uint64_t from, const std::uint64_t to) const {
+		if (to >= limit) {
+			throw std::domain_error("Value " + std::to_string(to) + " has more than " + std::to_string(length) + " digits");
+		}
+		if (from > to) {
+			return 0;
+		}
+
+		return CountUpTo(to) - (from ? CountUpTo(from - 1) : 0);
+	}
+};
+
+#endif
@@ -3,6 +3,9 @@
 #include <vector>
 #include <tuple>
 #include <algorithm>
+#include <cstdint>
+
+#include "PasswordCounter.h"
 
 const int powers[] = {
 	0,
@@ -49,10 +52,7 @@ bool IsValidPassword(const char pass[6]) {
 	return foundPair;
 }
 
-int CountPasswords() {
-	int minVal = 272091;
-	int maxVal = 815432;
-
+int CountPasswordsSlow(const int minVal, const int maxVal) {
 	char pass[6];
 
 	int counter = 0;
@@ -67,6 +67,10 @@ int CountPasswords() {
 	return counter;
 }
 
+std::uint64_t CountPasswords() {
+	return PasswordCounter{PairRule::ExactPair, 6}.Count(272091, 815432);
+}
+
 
 bool Test() {
 	std::vector<std::tuple<bool, int, const char*>> testCases = {
@@ -100,6 +104,16 @@ bool Test() {
 		}
 	}
 
+	const PasswordCounter counter{PairRule::ExactPair, 6};
+	for(const auto &[from, to] : {std::make_pair(0, 999999), std::make_pair(272091, 815432), std::make_pair(111122, 111122), std::make_pair(123450, 123443)}) {
+		const auto fast = counter.Count(from, to);
+		const auto slow = CountPasswordsSlow(from, to);
+		if(fast != static_cast<std::uint64_t>(slow)) {
+			std::cerr << "Bad count in [" << from << ", " << to << "]: " << fast << " (was expecting: " << slow << ")" << std::endl;
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -1,125 +1,175 @@
 #include <iostream>
 #include <cstdlib>
-#include <map>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
 #include <string>
 #include <iterator>
 #include <algorithm>
 #include <sstream>
 #include <numeric>
 #include <stdexcept>
-#include <stack>
 
 typedef std::string NodeId;
+typedef std::uint32_t OrbitId;
+
+// The orbits as a flat tree of interned ids. Roots are their own parents.
+// up[k][id] is the 2^k-th ancestor of id, for lowest common ancestor queries.
+struct OrbitTree {
+	std::unordered_map<NodeId, OrbitId> ids;
+	std::vector<OrbitId> parent;
+	std::vector<std::uint32_t> depth;
+	std::vector<std::vector<OrbitId>> up;
+
+	OrbitId Intern(const std::string &name) {
+		const auto [iter, inserted] = ids.emplace(name, static_cast<OrbitId>(parent.size()));
+		if(inserted){
+			parent.push_back(iter->second);
+		}
+		return iter->second;
+	}
 
-struct NodeInfo{
-	NodeId parent;
-	int totalDistance;
-};
-
-typedef std::map<NodeId, NodeInfo> OrbitMap;
-
-
-OrbitMap ReadMap(std::istream &is) {
-	OrbitMap result;
+	OrbitId Find(const NodeId &name) const {
+		const auto iter = ids.find(name);
+		if(iter == ids.cend()){
+			throw std::out_of_range("Unknown object: " + name);
+		}
+		return iter->second;
+	}
 
-	std::string line;
+	OrbitId Ancestor(OrbitId id, std::uint32_t distance) const {
+		for(std::size_t k = 0; distance; ++k, distance >>= 1){
+			if(distance & 1){
+				id = up[k][id];
+			}
+		}
+		return id;
+	}
 
-	for (int lineNo = 1; is && std::getline(is, line); ++lineNo){
-		const auto& from = std::cbegin(line);
-		const auto& to = std::cend(line);
+	OrbitId CommonAncestor(OrbitId a, OrbitId b) const {
+		if(depth[a] < depth[b]){
+			std::swap(a, b);
+		}
+		a = Ancestor(a, depth[a] - depth[b]);
+		if(a == b){
+			return a;
+		}
 
-		const auto& splitPos = std::find(from, to, ')');
-		if (splitPos == std::cend(line)){
-			std::cerr << lineNo << ": No ')' separator found."<< std::endl;
-			return {};
+		for(auto k = up.size(); k--; ){
+			if(up[k][a] != up[k][b]){
+				a = up[k][a];
+				b = up[k][b];
+			}
+		}
+		if(parent[a] != parent[b]){
+			throw std::domain_error("The objects are not orbiting the same center");
 		}
+		return parent[a];
+	}
+};
 
-		std::string name1{from, splitPos};
-		std::string name2{splitPos + 1, to};
+// Computes the depths in one breadth first pass from the roots and builds the
+// ancestor table. Fails on orbit loops.
+void Index(OrbitTree &tree) {
+	const auto size = tree.parent.size();
 
-		if(result.find(name2) != result.cend()){
-			std::cerr << lineNo << ": \"" <<  name2 << "\" already contained in the map." << std::endl;
-			return {};
+	// Children of id are children[childrenBegin[id], childrenBegin[id + 1])
+	std::vector<std::size_t> childrenBegin(size + 1, 0);
+	for(OrbitId id = 0; id < size; ++id){
+		if(tree.parent[id] != id){
+			++childrenBegin[tree.parent[id] + 1];
+		}
+	}
+	std::partial_sum(childrenBegin.begin(), childrenBegin.end(), childrenBegin.begin());
+
+	std::vector<OrbitId> children(childrenBegin.back());
+	std::vector<OrbitId> order;
+	order.reserve(size);
+	{
+		auto next = childrenBegin;
+		for(OrbitId id = 0; id < size; ++id){
+			if(tree.parent[id] != id){
+				children[next[tree.parent[id]]++] = id;
+			}
+			else{
+				order.push_back(id);
+			}
 		}
+	}
 
-		result[name2] = {name1, 0};
+	tree.depth.assign(size, 0);
+	for(std::size_t i = 0; i < order.size(); ++i){
+		const auto id = order[i];
+		for(auto c = childrenBegin[id]; c != childrenBegin[id + 1]; ++c){
+			tree.depth[children[c]] = tree.depth[id] + 1;
+			order.push_back(children[c]);
+		}
+	}
+	if(order.size() != size){
+		throw std::domain_error("The orbit map contains a loop");
 	}
 
+	const auto maxDepth = size ? *std::max_element(tree.depth.cbegin(), tree.depth.cend()) : 0;
+	std::size_t levels = 1;
+	while(maxDepth >> levels){
+		++levels;
+	}
 
-	return result;
+	tree.up.assign(levels, {});
+	tree.up[0] = tree.parent;
+	for(std::size_t k = 1; k < levels; ++k){
+		const auto &prev = tree.up[k - 1];
+		auto &current = tree.up[k];
+		current.resize(size);
+		for(OrbitId id = 0; id < size; ++id){
+			current[id] = prev[prev[id]];
+		}
+	}
 }
 
-std::ostream& operator<<(std::ostream &os, const NodeInfo &ni) {
-	os << "NodeInfo {" << ni.parent << ", " << ni.totalDistance << "}";
-
-	return os;
-}
+OrbitTree ReadTree(std::istream &is) {
+	OrbitTree result;
 
-template <typename TKey, typename TValue>
-std::ostream& operator<< (std::ostream& os, const std::map<TKey, TValue> &m){
-	os << '{';
-	const auto begin = std::begin(m);
-	const auto end = std::end(m);
+	std::string line;
 
-	for(auto i = begin; i != end; ++i) {
-		if(i != begin) {
-			os << ", ";
+	for (int lineNo = 1; is && std::getline(is, line); ++lineNo){
+		const auto splitPos = line.find(')');
+		if (splitPos == std::string::npos){
+			std::cerr << lineNo << ": No ')' separator found."<< std::endl;
+			return {};
 		}
-		os << i->first;
-		os << ": ";
-		os << i->second;
-	}
-	os << '}';
 
-	return os;
-}
+		const auto center = result.Intern(line.substr(0, splitPos));
+		const auto object = result.Intern(line.substr(splitPos + 1));
 
-// Assumes no loops in the graph
-int SourceDistance(OrbitMap &m, const NodeId &current){
-	if(current == "COM"){
-		return 0;
-	}
+		if(result.parent[object] != object){
+			std::cerr << lineNo << ": \"" <<  line.substr(splitPos + 1) << "\" already contained in the map." << std::endl;
+			return {};
+		}
 
-	auto &info = m[current];
-	if(!info.totalDistance){
-		info.totalDistance = SourceDistance(m, info.parent) + 1;
+		result.parent[object] = center;
 	}
 
-	return info.totalDistance;
-}
+	Index(result);
 
-int SumOrbits(OrbitMap &m) {
-	return std::accumulate(
-		m.begin(),
-		m.end(),
-		0,
-		[&](int partialSum, auto& entry) {
-			return partialSum + SourceDistance(m, entry.first);
-		});
+	return result;
 }
 
-std::stack<NodeId> RootPath(const OrbitMap &m, const NodeId& root, const NodeId &node){
-	std::stack<NodeId> result;
-	for(NodeId current = node; current != root; current = m.at(current).parent){
-		result.push(current);
-	}
-
-	result.push(root);
-
-	return result;
+std::uint64_t SumOrbits(const OrbitTree &tree) {
+	return std::accumulate(tree.depth.cbegin(), tree.depth.cend(), std::uint64_t{0});
 }
 
-int HopCount(const OrbitMap &m, const NodeId &from, const NodeId &to)
+// Orbital transfers needed to move from the object "from" orbits to the object "to" orbits
+std::int64_t HopCount(const OrbitTree &tree, const OrbitId from, const OrbitId to)
 {
-	NodeId root = "COM";
-	auto fromPath = RootPath(m, root, from);
-	auto toPath = RootPath(m, root, to);
+	const auto common = tree.CommonAncestor(from, to);
 
-	for (; !fromPath.empty() and !toPath.empty() && fromPath.top() == toPath.top(); fromPath.pop(), toPath.pop()){
-		root = fromPath.top();
-	}
+	return std::int64_t{tree.depth[from]} + tree.depth[to] - 2 * std::int64_t{tree.depth[common]} - 2;
+}
 
-	return (fromPath.size() -1) + (toPath.size() -1);
+std::int64_t HopCount(const OrbitTree &tree, const NodeId &from, const NodeId &to)
+{
+	return HopCount(tree, tree.Find(from), tree.Find(to));
 }
 
 bool Test() {
@@ -136,9 +186,8 @@ J)K
 K)L)";
 	std::istringstream ss{testInput};
 	
-	auto testMap = ReadMap(ss);
-	//std::cout << "TestMap: " << testMap << std::endl;
-	int orbits = SumOrbits(testMap);
+	const auto testTree = ReadTree(ss);
+	const auto orbits = SumOrbits(testTree);
 
 	if(orbits != 42) {
 		std::cout << "Bad number of orbits " << orbits << ". Was expecting " << 42 << "." << std::endl;
@@ -159,13 +208,43 @@ K)L
 K)YOU
 I)SAN)";
 	std::istringstream hopSS{hopTestInput};
-	int hops = HopCount(ReadMap(hopSS), "YOU", "SAN");
+	const auto hopTree = ReadTree(hopSS);
+	const auto hops = HopCount(hopTree, "YOU", "SAN");
 
 	if(hops != 4) {
 		std::cout << "Wrong number of hops " << hops << ". Was expecting " << 4 << "." << std::endl;
 		return false;
 	}
 
+	// A long chain with a branch every 1000 objects
+	std::ostringstream chain;
+	chain << "COM)0";
+	for(int i = 1; i < 100000; ++i){
+		chain << '\n' << i - 1 << ')' << i;
+		if(i % 1000 == 0){
+			chain << '\n' << i << ")B" << i;
+		}
+	}
+	std::istringstream chainSS{chain.str()};
+	const auto chainTree = ReadTree(chainSS);
+	if(const auto chainHops = HopCount(chainTree, "B3000", "B97000"); chainHops != 94000) {
+		std::cout << "Wrong number of chain hops " << chainHops << ". Was expecting " << 94000 << "." << std::endl;
+		return false;
+	}
+	if(const auto chainHops = HopCount(chainTree, "99999", "B5000"); chainHops != 94998) {
+		std::cout << "Wrong number of chain hops " << chainHops << ". Was expecting " << 94998 << "." << std::endl;
+		return false;
+	}
+
+	std::istringstream loopSS{"COM)A\nB)C\nC)B"};
+	try {
+		ReadTree(loopSS);
+		std::cout << "Orbit loop was accepted." << std::endl;
+		return false;
+	}
+	catch(const std::domain_error &) {
+	}
+
 	return true;
 }
 
@@ -177,10 +256,10 @@ int main(int, const char**){
 		return EXIT_FAILURE;
 	}
 
-	auto inputMap = ReadMap(std::cin);
-	const int orbits = SumOrbits(inputMap);
+	const auto inputTree = ReadTree(std::cin);
+	const auto orbits = SumOrbits(inputTree);
 	std::cout << "Orbits: " << orbits << std::endl;
-	const int hops = HopCount(inputMap, "YOU", "SAN");
+	const auto hops = HopCount(inputTree, "YOU", "SAN");
 	std::cout << "Hops: " << hops << std::endl;
 
 	return EXIT_SUCCESS;
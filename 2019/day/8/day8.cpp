@@ -3,104 +3,218 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
-#include <numeric>
-#include <map>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <cctype>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 struct Dimmentions{
 	int width;
 	int height;
-	constexpr int size() const {
-		return width * height;
+	constexpr std::size_t size() const {
+		return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
 	}
 };
 
-typedef std::vector<int> Layer;
-typedef std::vector<int> Image;
-
 enum Color {
-	Black = 0,
-	White,
-	Transparent
+	Black = '0',
+	White = '1',
+	Transparent = '2'
 };
 
-int main(int, char**){
-	std::cout << "Day 8" << std::endl;
+struct LayerStats {
+	std::size_t zeros;
+	std::size_t ones;
+	std::size_t twos;
+};
+
+// Counts the '0', '1' and '2' bytes of a layer, 16 bytes at a time when SSE2 is available
+LayerStats CountDigits(const char *data, const std::size_t size) {
+	LayerStats result{0, 0, 0};
+	std::size_t i = 0;
+
+#ifdef __SSE2__
+	const auto zero = _mm_set1_epi8('0');
+	const auto one = _mm_set1_epi8('1');
+	const auto two = _mm_set1_epi8('2');
+	for(; i + 16 <= size; i += 16){
+		const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+		result.zeros += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)));
+		result.ones += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, one)));
+		result.twos += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, two)));
+	}
+#endif
+
+	for(; i < size; ++i){
+		result.zeros += data[i] == '0';
+		result.ones += data[i] == '1';
+		result.twos += data[i] == '2';
+	}
+
+	return result;
+}
+
+// Places the layer under the image: only the transparent pixels of the image take the layer's value
+void CompositeUnder(char *image, const char *layer, const std::size_t size) {
+	std::size_t i = 0;
+
+#ifdef __SSE2__
+	const auto transparent = _mm_set1_epi8(Color::Transparent);
+	for(; i + 16 <= size; i += 16){
+		const auto top = _mm_loadu_si128(reinterpret_cast<const __m128i *>(image + i));
+		const auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i *>(layer + i));
+		const auto mask = _mm_cmpeq_epi8(top, transparent);
+		const auto blended = _mm_or_si128(_mm_and_si128(mask, bottom), _mm_andnot_si128(mask, top));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(image + i), blended);
+	}
+#endif
+
+	for(; i < size; ++i){
+		image[i] = image[i] == Color::Transparent ? layer[i] : image[i];
+	}
+}
+
+// Decodes a Space Image Format stream one layer at a time, keeping only the
+// current layer and the composited image in memory.
+class ImageDecoder {
+	const Dimmentions d;
+	std::vector<char> layer;
+	std::vector<char> image;
+	std::size_t layerCount = 0;
+	LayerStats fewestZeros{std::numeric_limits<std::size_t>::max(), 0, 0};
+
+public:
+	explicit ImageDecoder(const Dimmentions &d)
+		: d(d)
+		, layer(LayerSize(d))
+		, image(layer.size(), Color::Transparent)
+	{
+	}
 
-	std::vector<int> input;
-	std::transform(
-		std::istream_iterator<char>(std::cin),
-		std::istream_iterator<char>(),
-		std::back_inserter(input),
-		[](const char ch){
-			return int(ch) - '0';
-		});
-
-	constexpr const Dimmentions d{25, 6};
-	const auto layerCount = input.size() / d.size();
-	std::vector<Layer> layers;
-	layers.reserve(layerCount);
-
-	for(auto i = decltype(layerCount){0}; i < layerCount; ++i) {
-		layers.emplace_back(
-			input.cbegin() + (i * d.size()),
-			input.cbegin() + ((i+1) * d.size()));
-	}
-
-	std::map<std::pair<const Layer *, int>, int> countMemory;
-	const auto count = [&](const auto &v, const int elem) -> int {
-		const auto key = std::make_pair(&v, elem);
-
-		const auto existing = countMemory.find(key);
-		if(existing != countMemory.cend()){
-			return existing->second;
+	// Checked before anything is allocated
+	static std::size_t LayerSize(const Dimmentions &d) {
+		if(d.width <= 0 || d.height <= 0){
+			throw std::domain_error("Bad image dimensions.");
 		}
+		return d.size();
+	}
 
-		const auto result = std::count(v.cbegin(), v.cend(), elem);
-		countMemory.insert({key, result});
+	void AddLayer(const char *data) {
+		const auto stats = CountDigits(data, image.size());
+		if(stats.zeros < fewestZeros.zeros){
+			fewestZeros = stats;
+		}
 
-		return result;
-	};
-
-	const auto &selected = std::min_element(
-		layers.cbegin(),
-		layers.cend(),
-		[&count](const auto &l1, const auto &l2) {
-			return count(l1, 0) < count(l2, 0);
-		});
-
-	const auto result = count(*selected, 1) * count(*selected, 2);
-
-	std::cout << "Result: " << result << std::endl;
-
-	// Render Image
-
-	const auto image = std::accumulate(
-		layers.crbegin(),
-		layers.crend(),
-		Image(d.size(), Color::Black),
-		[](auto &image, const auto &layer) {
-			// apply layer onto image
-			std::transform(
-				image.begin(), image.end(),
-				layer.begin(),
-				image.begin(),
-				[](const auto &imgValue, const auto &lValue){
-					return lValue == Color::Transparent ? imgValue : lValue;
-				});
-			return image;
-		});
-
-	// display image
-	for(int y = 0; y < d.height; ++y) {
-		for(int x = 0; x < d.width; ++x){
-			switch(image[y*d.width + x]){
-				case Color::Black:       std::cout << ' '; break;
-				case Color::White:       std::cout << '.'; break;
-				case Color::Transparent: std::cout << ' '; break;
+		// Layers come front to back
+		CompositeUnder(image.data(), data, image.size());
+		++layerCount;
+	}
+
+	void Decode(std::istream &is) {
+		while(is.read(layer.data(), layer.size())){
+			AddLayer(layer.data());
+		}
+
+		const auto trailing = is.gcount();
+		if(std::any_of(layer.cbegin(), layer.cbegin() + trailing, [](const char c) { return !std::isspace(static_cast<unsigned char>(c)); })){
+			throw std::runtime_error("Incomplete layer at the end of the input.");
+		}
+	}
+
+	std::size_t LayerCount() const {
+		return layerCount;
+	}
+
+	// Number of '1' digits multiplied by the number of '2' digits of the layer with the fewest '0' digits
+	std::size_t Checksum() const {
+		return layerCount ? fewestZeros.ones * fewestZeros.twos : 0;
+	}
+
+	const std::vector<char> &Image() const {
+		return image;
+	}
+
+	std::string Render() const {
+		std::string result;
+		result.reserve((d.width + 1) * d.height);
+		for(int y = 0; y < d.height; ++y) {
+			for(int x = 0; x < d.width; ++x){
+				result.push_back(image[y*d.width + x] == Color::White ? '.' : ' ');
 			}
+			result.push_back('\n');
 		}
-		std::cout << std::endl;
+		return result;
+	}
+};
+
+bool Test() {
+	std::istringstream checksumInput{"123456789012\n"};
+	ImageDecoder checksumDecoder{{3, 2}};
+	checksumDecoder.Decode(checksumInput);
+	if(checksumDecoder.LayerCount() != 2 || checksumDecoder.Checksum() != 1) {
+		std::cerr << "Bad checksum " << checksumDecoder.Checksum() << ". Was expecting 1." << std::endl;
+		return false;
+	}
+
+	std::istringstream imageInput{"0222112222120000"};
+	ImageDecoder imageDecoder{{2, 2}};
+	imageDecoder.Decode(imageInput);
+	if(std::string(imageDecoder.Image().cbegin(), imageDecoder.Image().cend()) != "0110") {
+		std::cerr << "Bad composited image." << std::endl;
+		return false;
 	}
 
+	// Wide enough to go through the vectorized paths
+	std::string layers;
+	layers += std::string(40, '2') + std::string(10, '0');
+	layers += std::string(20, '1') + std::string(20, '2') + std::string(10, '1');
+	layers += std::string(50, '0');
+	std::istringstream wideInput{layers};
+	ImageDecoder wideDecoder{{25, 2}};
+	wideDecoder.Decode(wideInput);
+	const auto &wide = wideDecoder.Image();
+	if(wideDecoder.Checksum() != 30 * 20
+		|| std::count(wide.cbegin(), wide.cbegin() + 20, '1') != 20
+		|| std::count(wide.cbegin() + 20, wide.cend(), '0') != 30) {
+		std::cerr << "Bad wide image, checksum " << wideDecoder.Checksum() << "." << std::endl;
+		return false;
+	}
+
+	try {
+		ImageDecoder badDecoder{{-1, 6}};
+		std::cerr << "Negative image width was accepted." << std::endl;
+		return false;
+	}
+	catch(const std::domain_error &) {
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv){
+	std::cout << "Day 8" << std::endl;
+
+	if(!Test()){
+		std::cerr << "Tests failed." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Dimmentions d{25, 6};
+	if(argc == 3){
+		d = {std::atoi(argv[1]), std::atoi(argv[2])};
+	}
+
+	ImageDecoder decoder{d};
+	decoder.Decode(std::cin);
+
+	std::cout << "Result: " << decoder.Checksum() << std::endl;
+
+	std::cout << decoder.Render();
+
 	return EXIT_SUCCESS;
 }
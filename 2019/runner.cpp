@@ -0,0 +1,261 @@
+// Runs the 2019 solvers and reports wall time, CPU time and peak RSS per day.
+//
+// Every solver is linked in as a function (its renamed main). Each one runs in
+// a forked child with the day's input on stdin, which keeps the solvers' global
+// state and stdin/stdout apart and gives per day resource usage from wait4.
+//
+// usage: runner [-j jobs] [-o output_dir] [day...]
+// Days are selected by name (e.g. 14 or 1/second), all by default. The table
+// goes to stdout as tab separated values.
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef int (*Solver)(int, char **);
+
+extern "C" {
+	int aoc2019_1_first(int, char **);
+	int aoc2019_1_second(int, char **);
+	int aoc2019_2_first(int, char **);
+	int aoc2019_2_second(int, char **);
+	int aoc2019_3_both(int, char **);
+	int aoc2019_4_first(int, char **);
+	int aoc2019_4_second(int, char **);
+	int aoc2019_5_first(int, char **);
+	int aoc2019_5_second(int, char **);
+	int aoc2019_6_day6(int, char **);
+	int aoc2019_7_day7(int, char **);
+	int aoc2019_8_day8(int, char **);
+	int aoc2019_9_day9(int, char **);
+	int aoc2019_10_day10(int, char **);
+	int aoc2019_11_day11(int, char **);
+	int aoc2019_12_day12(int, char **);
+	int aoc2019_13_day13(int, char **);
+	int aoc2019_14_day14(int, char **);
+	int aoc2019_15_day15(int, char **);
+	int aoc2019_16_day16(int, char **);
+	int aoc2019_17_day17(int, char **);
+}
+
+struct Day {
+	std::string name;
+	Solver solver;
+	// Relative to the runner's working directory, empty when the day reads no input
+	std::string input;
+};
+
+const std::vector<Day> Days = {
+	{"1/first", aoc2019_1_first, "day/1/input/input"},
+	{"1/second", aoc2019_1_second, "day/1/input/input"},
+	{"2/first", aoc2019_2_first, "day/2/input/input"},
+	{"2/second", aoc2019_2_second, "day/2/input/input"},
+	{"3/both", aoc2019_3_both, "day/3/input/input"},
+	{"4/first", aoc2019_4_first, ""},
+	{"4/second", aoc2019_4_second, ""},
+	{"5/first", aoc2019_5_first, "day/5/input"},
+	{"5/second", aoc2019_5_second, "day/5/input"},
+	{"6/day6", aoc2019_6_day6, "day/6/input"},
+	{"7/day7", aoc2019_7_day7, "day/7/input"},
+	{"8/day8", aoc2019_8_day8, "day/8/input"},
+	{"9/day9", aoc2019_9_day9, "day/9/input"},
+	{"10/day10", aoc2019_10_day10, "day/10/input"},
+	{"11/day11", aoc2019_11_day11, "day/11/input"},
+	{"12/day12", aoc2019_12_day12, "day/12/input"},
+	{"13/day13", aoc2019_13_day13, "day/13/input"},
+	{"14/day14", aoc2019_14_day14, "day/14/input"},
+	{"15/day15", aoc2019_15_day15, "day/15/input"},
+	{"16/day16", aoc2019_16_day16, "day/16/input"},
+	{"17/day17", aoc2019_17_day17, "day/17/input"},
+};
+
+struct Measurement {
+	int status;
+	double wallMs;
+	double cpuMs;
+	long peakRssKb;
+};
+
+// Never returns, runs in the forked child
+[[noreturn]] void RunChild(const Day &day, const std::string &outputDir) {
+	const int in = open(day.input.empty() ? "/dev/null" : day.input.c_str(), O_RDONLY);
+	if (in < 0) {
+		std::cerr << day.name << ": can't open " << day.input << ": " << std::strerror(errno) << std::endl;
+		_exit(127);
+	}
+
+	std::string outputPath = "/dev/null";
+	if (!outputDir.empty()) {
+		outputPath = outputDir + "/" + day.name;
+		std::replace(outputPath.begin() + outputDir.size() + 1, outputPath.end(), '/', '_');
+		outputPath += ".txt";
+	}
+	const int out = open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (out < 0) {
+		std::cerr << day.name << ": can't open " << outputPath << ": " << std::strerror(errno) << std::endl;
+		_exit(127);
+	}
+
+	dup2(in, STDIN_FILENO);
+	dup2(out, STDOUT_FILENO);
+	dup2(out, STDERR_FILENO);
+	close(in);
+	close(out);
+
+	int status = EXIT_FAILURE;
+	try {
+		std::vector<char> name(day.name.cbegin(), day.name.cend());
+		name.push_back('\0');
+		char *argv[] = {name.data(), nullptr};
+		status = day.solver(1, argv);
+	}
+	catch (const std::exception &e) {
+		std::cerr << "Uncaught exception: " << e.what() << std::endl;
+	}
+
+	std::exit(status);
+}
+
+std::map<const Day *, Measurement> RunDays(const std::vector<const Day *> &days, const unsigned jobs, const std::string &outputDir) {
+	typedef std::chrono::steady_clock Clock;
+
+	struct Running {
+		const Day *day;
+		Clock::time_point start;
+	};
+
+	std::map<const Day *, Measurement> result;
+	std::map<pid_t, Running> running;
+	auto next = days.cbegin();
+
+	std::cout.flush();
+	std::cerr.flush();
+
+	while (next != days.cend() || !running.empty()) {
+		while (next != days.cend() && running.size() < jobs) {
+			const auto start = Clock::now();
+			const pid_t pid = fork();
+			if (pid < 0) {
+				throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+			}
+			if (pid == 0) {
+				RunChild(**next, outputDir);
+			}
+			running[pid] = {*next, start};
+			++next;
+		}
+
+		int status;
+		struct rusage usage;
+		const pid_t pid = wait4(-1, &status, 0, &usage);
+		if (pid < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::runtime_error(std::string("wait4 failed: ") + std::strerror(errno));
+		}
+		const auto end = Clock::now();
+
+		const auto iter = running.find(pid);
+		if (iter == running.end()) {
+			continue;
+		}
+
+		const auto toMs = [](const timeval &tv) {
+			return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+		};
+
+		result[iter->second.day] = {
+			WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status),
+			std::chrono::duration<double, std::milli>(end - iter->second.start).count(),
+			toMs(usage.ru_utime) + toMs(usage.ru_stime),
+			usage.ru_maxrss};
+		running.erase(iter);
+	}
+
+	return result;
+}
+
+int main(int argc, char **argv) {
+	unsigned jobs = 1;
+	std::string outputDir;
+	std::vector<const Day *> selected;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if ((arg == "-j" || arg == "-o") && i + 1 < argc) {
+			if (arg == "-j") {
+				jobs = std::max(1, std::atoi(argv[++i]));
+			}
+			else {
+				outputDir = argv[++i];
+			}
+			continue;
+		}
+
+		bool found = false;
+		for (const auto &day : Days) {
+			if (day.name == arg || day.name.substr(0, day.name.find('/')) == arg) {
+				selected.push_back(&day);
+				found = true;
+			}
+		}
+		if (!found) {
+			std::cerr << "usage: " << argv[0] << " [-j jobs] [-o output_dir] [day...]" << std::endl;
+			std::cerr << "Unknown day " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (selected.empty()) {
+		for (const auto &day : Days) {
+			selected.push_back(&day);
+		}
+	}
+
+	if (!outputDir.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(outputDir, error);
+		if (error) {
+			std::cerr << "Can't create the output directory " << outputDir << ": " << error.message() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto measurements = RunDays(selected, jobs, outputDir);
+	const auto totalWall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "day\tstatus\twall_ms\tcpu_ms\tpeak_rss_kb" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	bool success = true;
+	double totalCpu = 0;
+	long peakRss = 0;
+	for (const auto *day : selected) {
+		const auto &m = measurements.at(day);
+		std::cout << day->name << '\t' << m.status << '\t' << m.wallMs << '\t' << m.cpuMs << '\t' << m.peakRssKb << std::endl;
+
+		success = success && m.status == EXIT_SUCCESS;
+		totalCpu += m.cpuMs;
+		peakRss = std::max(peakRss, m.peakRssKb);
+	}
+	std::cout << "total\t" << (success ? 0 : 1) << '\t' << totalWall << '\t' << totalCpu << '\t' << peakRss << std::endl;
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
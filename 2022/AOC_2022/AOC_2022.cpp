@@ -1,12 +1,263 @@
 #include "day.h"
+#include "utils.h"
+#include "QueueBenchmark.h"
 
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+#include <string>
+#include <map>
+#include <regex>
+#include <cmath>
 
 using namespace std;
 
-int main() {
-    vector<DayResult(*)()> days{
+struct DayRun {
+    DayResult result;
+    chrono::nanoseconds duration{};
+    exception_ptr error;
+};
+
+// Runs the days on a pool of threads, each thread taking the next day not yet started
+vector<DayRun> runDays(const vector<DayResult(*)()>& days, size_t threadCount) {
+    vector<DayRun> runs(days.size());
+    atomic<size_t> next{ 0 };
+
+    const auto worker = [&]() {
+        for (size_t i; (i = next++) < days.size();) {
+            const auto start = chrono::steady_clock::now();
+            try {
+                runs[i].result = days[i]();
+            }
+            catch (...) {
+                runs[i].error = current_exception();
+            }
+            runs[i].duration = chrono::steady_clock::now() - start;
+        }
+    };
+
+    threadCount = clamp<size_t>(threadCount, 1, days.size());
+    vector<jthread> pool;
+    for (size_t t = 1; t < threadCount; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+
+    return runs;
+}
+
+void printPart(const optional<PartialDayResult>& part) {
+    if (part.has_value()) {
+        cout << part->description << ": " << part->value
+            << " (" << chrono::duration<double, milli>(part->duration).count() << " ms)" << endl;
+    }
+}
+
+struct BenchmarkOptions {
+    int day = 0;
+    int runs = 20;
+    int warmup = 3;
+    // Report the time spent in readFile separately from solving
+    bool splitRead = false;
+    string jsonPath;
+    string baselinePath;
+    // Allowed slowdown of a median against the baseline, in percent
+    double threshold = 5;
+};
+
+struct TimingStats {
+    chrono::nanoseconds min;
+    chrono::nanoseconds median;
+    chrono::nanoseconds p99;
+};
+
+TimingStats computeStats(vector<chrono::nanoseconds> samples) {
+    ranges::sort(samples);
+    // nearest rank percentile
+    const auto rank = [&samples](double percentile) {
+        const auto index = static_cast<size_t>(ceil(percentile * samples.size()));
+        return samples[clamp<size_t>(index, 1, samples.size()) - 1];
+    };
+
+    return { samples.front(), rank(0.5), rank(0.99) };
+}
+
+// Flat JSON object: "<metric>.<stat>_ns": value
+string toJson(const BenchmarkOptions& options, const vector<pair<string, TimingStats>>& metrics) {
+    ostringstream os;
+    os << "{\n";
+    os << "    \"day\": " << options.day << ",\n";
+    os << "    \"runs\": " << options.runs << ",\n";
+    os << "    \"warmup\": " << options.warmup;
+    for (const auto& [name, stats] : metrics) {
+        os << ",\n    \"" << name << ".min_ns\": " << stats.min.count();
+        os << ",\n    \"" << name << ".median_ns\": " << stats.median.count();
+        os << ",\n    \"" << name << ".p99_ns\": " << stats.p99.count();
+    }
+    os << "\n}\n";
+
+    return os.str();
+}
+
+// Reads back the numeric fields of a file written by toJson
+map<string, double> readJson(const string& path) {
+    ifstream infile(path);
+    if (!infile) {
+        throw runtime_error("Couldn't open " + path);
+    }
+    const string contents{ istreambuf_iterator<char>(infile), istreambuf_iterator<char>() };
+
+    map<string, double> result;
+    const regex field{ R"rx("([^"]+)"\s*:\s*(-?[0-9.eE+-]+))rx" };
+    for (auto it = sregex_iterator(contents.begin(), contents.end(), field); it != sregex_iterator(); ++it) {
+        result[(*it)[1]] = stod((*it)[2]);
+    }
+
+    return result;
+}
+
+// Prints the median of each metric against the baseline, returns the number of regressions
+int compareWithBaseline(const BenchmarkOptions& options, const vector<pair<string, TimingStats>>& metrics) {
+    const auto baseline = readJson(options.baselinePath);
+    if (baseline.contains("day") && baseline.at("day") != options.day) {
+        throw runtime_error("The baseline is for day " + to_string(static_cast<int>(baseline.at("day"))));
+    }
+
+    int regressions = 0;
+    cout << "Comparison with " << options.baselinePath << " (medians, threshold " << options.threshold << "%)" << endl;
+    for (const auto& [name, stats] : metrics) {
+        const auto iter = baseline.find(name + ".median_ns");
+        if (iter == baseline.end() || iter->second <= 0) {
+            cout << "  " << name << ": no baseline" << endl;
+            continue;
+        }
+
+        const double current = static_cast<double>(stats.median.count());
+        const double change = (current - iter->second) / iter->second * 100;
+        const bool regressed = change > options.threshold;
+        regressions += regressed;
+
+        cout << "  " << name << ": " << iter->second / 1e6 << " ms -> " << current / 1e6 << " ms ("
+            << (change >= 0 ? "+" : "") << change << "%)" << (regressed ? " REGRESSION" : "") << endl;
+    }
+
+    return regressions;
+}
+
+int benchmark(const vector<DayResult(*)()>& days, const BenchmarkOptions& options) {
+    if (options.day < 1 || static_cast<size_t>(options.day) > days.size()) {
+        throw runtime_error("No day " + to_string(options.day));
+    }
+    if (options.runs < 1) {
+        throw runtime_error("At least one run is needed");
+    }
+    const auto day = days[options.day - 1];
+
+    for (int i = 0; i < options.warmup; ++i) {
+        day();
+    }
+
+    vector<chrono::nanoseconds> total, part1, part2, read, solve;
+    for (int i = 0; i < options.runs; ++i) {
+        const auto readBefore = readFileTime();
+        const auto start = chrono::steady_clock::now();
+        const auto result = day();
+        const chrono::nanoseconds duration = chrono::steady_clock::now() - start;
+        const auto readDuration = readFileTime() - readBefore;
+
+        total.push_back(duration);
+        part1.push_back(result.part1.has_value() ? result.part1->duration : chrono::nanoseconds{});
+        part2.push_back(result.part2.has_value() ? result.part2->duration : chrono::nanoseconds{});
+        read.push_back(readDuration);
+        solve.push_back(duration - readDuration);
+    }
+
+    vector<pair<string, TimingStats>> metrics{
+        { "total", computeStats(total) },
+        { "part1", computeStats(part1) },
+        { "part2", computeStats(part2) },
+    };
+    if (options.splitRead) {
+        metrics.emplace_back("read", computeStats(read));
+        metrics.emplace_back("solve", computeStats(solve));
+    }
+
+    cout << "Day " << options.day << ", " << options.runs << " runs after " << options.warmup << " warmup runs" << endl;
+    for (const auto& [name, stats] : metrics) {
+        cout << "  " << name << ": min " << chrono::duration<double, milli>(stats.min).count()
+            << " ms, median " << chrono::duration<double, milli>(stats.median).count()
+            << " ms, p99 " << chrono::duration<double, milli>(stats.p99).count() << " ms" << endl;
+    }
+
+    if (!options.jsonPath.empty()) {
+        ofstream outfile(options.jsonPath);
+        if (!(outfile << toJson(options, metrics))) {
+            throw runtime_error("Couldn't write " + options.jsonPath);
+        }
+    }
+
+    if (!options.baselinePath.empty() && compareWithBaseline(options, metrics)) {
+        return 2;
+    }
+
+    return 0;
+}
+
+BenchmarkOptions parseBenchmarkOptions(const vector<string>& args) {
+    BenchmarkOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const auto value = [&]() -> const string& {
+            if (i + 1 >= args.size()) {
+                throw runtime_error("Missing value for " + args[i]);
+            }
+            return args[++i];
+        };
+
+        if (args[i] == "--bench") {
+            options.day = stoi(value());
+        }
+        else if (args[i] == "--runs") {
+            options.runs = stoi(value());
+        }
+        else if (args[i] == "--warmup") {
+            options.warmup = stoi(value());
+        }
+        else if (args[i] == "--split-read") {
+            options.splitRead = true;
+        }
+        else if (args[i] == "--json") {
+            options.jsonPath = value();
+        }
+        else if (args[i] == "--compare") {
+            options.baselinePath = value();
+        }
+        else if (args[i] == "--threshold") {
+            options.threshold = stod(value());
+        }
+        else {
+            throw runtime_error("Unknown argument " + args[i]);
+        }
+    }
+
+    return options;
+}
+
+// Without arguments runs every day once. Benchmark mode:
+// AOC_2022 --bench <day> [--runs n] [--warmup n] [--split-read] [--json out.json]
+//          [--compare baseline.json] [--threshold percent]
+// BucketQueue against std::priority_queue, on grids up to 10000x10000 by default:
+// AOC_2022 --queue-bench [max side]
+// Stress checks of the solvers, too slow for every run:
+// AOC_2022 --self-check
+int main(int argc, char* argv[]) {
+    const vector<DayResult(*)()> days{
         day1,
         day2,
         day3,
@@ -21,18 +272,64 @@ int main() {
         day12,
     };
 
-    for (int i = 0; i < days.size(); ++i) {
-        cout << "Day " << i + 1 << endl;
-        const auto [partial1, partial2] = days.at(i)();
-        if (partial1.has_value()) {
-            cout << partial1->description << ": " << partial1->value << endl;
+    if (argc > 1 && argv[1] == string("--queue-bench")) {
+        return queueBenchmark(argc > 2 ? stoul(argv[2]) : 10000) ? 0 : 1;
+    }
+
+    if (argc > 1 && argv[1] == string("--self-check")) {
+        return day9SelfCheck() ? 0 : 1;
+    }
+
+    if (argc > 1) {
+        try {
+            return benchmark(days, parseBenchmarkOptions({ argv + 1, argv + argc }));
         }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    // At most one day per core, the days that start threads of their own share the rest
+    const auto threadCount = clamp<size_t>(thread::hardware_concurrency(), 1, days.size());
+    setConcurrentDays(static_cast<unsigned>(threadCount));
+
+    const auto cpuStart = processCpuTime();
+    const auto start = chrono::steady_clock::now();
+    const auto runs = runDays(days, threadCount);
+    const chrono::duration<double, milli> wallTime = chrono::steady_clock::now() - start;
+    const chrono::duration<double, milli> cpuTime = processCpuTime() - cpuStart;
+
+    setConcurrentDays(1);
 
-        if (partial2.has_value()) {
-            cout << partial2->description << ": " << partial2->value << endl;
+    int failures = 0;
+
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const auto& run = runs[i];
+
+        cout << "Day " << i + 1 << " (" << chrono::duration<double, milli>(run.duration).count() << " ms)" << endl;
+        if (run.error) {
+            ++failures;
+            try {
+                rethrow_exception(run.error);
+            }
+            catch (const exception& e) {
+                cout << "Failed: " << e.what() << endl;
+            }
+            catch (...) {
+                cout << "Failed" << endl;
+            }
+            cout << endl;
+            continue;
         }
+
+        printPart(run.result.part1);
+        printPart(run.result.part2);
         cout << endl;
     }
 
-    return 0;
+    cout << "Total wall time: " << wallTime.count() << " ms" << endl;
+    cout << "Total CPU time: " << cpuTime.count() << " ms" << endl;
+
+    return failures ? 1 : 0;
 }
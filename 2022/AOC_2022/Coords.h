@@ -5,6 +5,8 @@
 #include "Point2.h"
 
 using Coords = Point2<int>;
+// For positions that can go beyond the range of int
+using LongCoords = Point2<long long>;
 extern const Coords Origin;
 extern const Coords Up;
 extern const Coords Down;
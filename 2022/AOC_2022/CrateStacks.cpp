@@ -0,0 +1,115 @@
+#include "CrateStacks.h"
+
+#include <algorithm>
+#include <cstring>
+
+CrateStack::CrateStack(std::string_view bottomToTop)
+    : crates(bottomToTop.begin(), bottomToTop.end())
+{
+}
+
+size_t CrateStack::size() const {
+    return crates.size();
+}
+
+char CrateStack::top() const {
+    if (crates.empty()) {
+        throw std::out_of_range("Empty stack");
+    }
+    return crates.back();
+}
+
+void CrateStack::moveTo(CrateStack& target, size_t amount, bool keepOrder) {
+    const auto moved = crates.data() + crates.size() - amount;
+    const auto targetSize = target.crates.size();
+    target.crates.resize(targetSize + amount);
+
+    if (keepOrder) {
+        std::memcpy(target.crates.data() + targetSize, moved, amount);
+    }
+    else {
+        std::reverse_copy(moved, moved + amount, target.crates.data() + targetSize);
+    }
+
+    crates.resize(crates.size() - amount);
+}
+
+std::string CrateStack::contents() const {
+    return { crates.begin(), crates.end() };
+}
+
+ChunkedCrateStack::ChunkedCrateStack(std::string_view bottomToTop)
+    : count(bottomToTop.size())
+{
+    if (!bottomToTop.empty()) {
+        chunks.push_back({ std::make_shared<const std::vector<char>>(bottomToTop.begin(), bottomToTop.end()), 0, bottomToTop.size(), false });
+    }
+}
+
+size_t ChunkedCrateStack::size() const {
+    return count;
+}
+
+char ChunkedCrateStack::top() const {
+    if (chunks.empty()) {
+        throw std::out_of_range("Empty stack");
+    }
+    const auto& chunk = chunks.back();
+    return (*chunk.buffer)[chunk.reversed ? chunk.begin : chunk.end - 1];
+}
+
+void ChunkedCrateStack::moveTo(ChunkedCrateStack& target, size_t amount, bool keepOrder) {
+    // Find the first chunk that moves, splitting it if only its top moves
+    size_t first = chunks.size();
+    size_t remaining = amount;
+    while (remaining > 0) {
+        auto& chunk = chunks[--first];
+        if (chunk.size() > remaining) {
+            // The bottom crates of a reversed chunk are at its end
+            const size_t split = chunk.reversed ? chunk.begin + remaining : chunk.end - remaining;
+            Chunk upper = chunk;
+            if (chunk.reversed) {
+                upper.end = split;
+                chunk.begin = split;
+            }
+            else {
+                upper.begin = split;
+                chunk.end = split;
+            }
+            chunks.insert(chunks.begin() + ++first, upper);
+            break;
+        }
+        remaining -= chunk.size();
+    }
+
+    if (keepOrder) {
+        target.chunks.insert(target.chunks.end(), chunks.begin() + first, chunks.end());
+    }
+    else {
+        // One crate at a time turns the moved part upside down
+        for (auto chunk = chunks.rbegin(); chunk != chunks.rend() - first; ++chunk) {
+            target.chunks.push_back(*chunk);
+            target.chunks.back().reversed = !chunk->reversed;
+        }
+    }
+
+    chunks.resize(first);
+    count -= amount;
+    target.count += amount;
+}
+
+std::string ChunkedCrateStack::contents() const {
+    std::string result;
+    result.reserve(count);
+    for (const auto& chunk : chunks) {
+        const auto begin = chunk.buffer->begin() + chunk.begin;
+        const auto end = chunk.buffer->begin() + chunk.end;
+        if (chunk.reversed) {
+            result.append(std::make_reverse_iterator(end), std::make_reverse_iterator(begin));
+        }
+        else {
+            result.append(begin, end);
+        }
+    }
+    return result;
+}
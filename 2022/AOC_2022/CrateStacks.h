@@ -0,0 +1,123 @@
+#ifndef CrateStacks_h_
+#define CrateStacks_h_
+
+#include "StackCommand.h"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include <ostream>
+
+// The crates, bottom first, in one vector: a move is one bulk copy of the top
+class CrateStack {
+    std::vector<char> crates;
+
+public:
+    CrateStack(std::string_view bottomToTop);
+
+    size_t size() const;
+    char top() const;
+
+    // Moves the top amount crates onto target, either one at a time (which
+    // reverses them) or all at once (which keeps their order)
+    void moveTo(CrateStack& target, size_t amount, bool keepOrder);
+
+    std::string contents() const;
+
+    friend std::ostream& operator<< (std::ostream&, const CrateStack&);
+};
+
+// The crates as slices of shared buffers: a move splices the slices and splits
+// at most one of them, so its cost depends on the slices moved and not on the
+// crates. Pays off when the stacks hold and move millions of crates.
+class ChunkedCrateStack {
+    struct Chunk {
+        std::shared_ptr<const std::vector<char>> buffer;
+        size_t begin;
+        size_t end;
+        // Read from end to begin, bottom first
+        bool reversed;
+
+        size_t size() const {
+            return end - begin;
+        }
+    };
+
+    std::vector<Chunk> chunks;
+    size_t count = 0;
+
+public:
+    ChunkedCrateStack(std::string_view bottomToTop);
+
+    size_t size() const;
+    char top() const;
+
+    void moveTo(ChunkedCrateStack& target, size_t amount, bool keepOrder);
+
+    std::string contents() const;
+
+    friend std::ostream& operator<< (std::ostream&, const ChunkedCrateStack&);
+};
+
+// The stacks in the order of their labels. The labels are numbers, so a tag
+// finds its stack by indexing and commands carry indices after parsing.
+template <typename TStack>
+class CrateStacks {
+    std::vector<TStack> stacks;
+    // stack index + 1 by tag, 0 for no stack
+    std::vector<size_t> indexByTag;
+
+public:
+    CrateStacks(const std::vector<size_t>& tags, const std::vector<std::string>& contents) {
+        if (tags.size() != contents.size()) {
+            throw std::invalid_argument("Every stack needs a tag");
+        }
+
+        for (size_t i = 0; i < tags.size(); ++i) {
+            if (tags[i] >= indexByTag.size()) {
+                indexByTag.resize(tags[i] + 1, 0);
+            }
+            if (indexByTag[tags[i]] != 0) {
+                throw std::invalid_argument("Duplicate stack tag " + std::to_string(tags[i]));
+            }
+            indexByTag[tags[i]] = i + 1;
+            stacks.emplace_back(contents[i]);
+        }
+    }
+
+    size_t index(size_t tag) const {
+        if (tag >= indexByTag.size() || indexByTag[tag] == 0) {
+            throw std::out_of_range("No stack tagged " + std::to_string(tag));
+        }
+        return indexByTag[tag] - 1;
+    }
+
+    void execute(const StackCommand& cmd, bool keepOrder) {
+        auto& source = stacks.at(cmd.source);
+        auto& target = stacks.at(cmd.target);
+        if (source.size() < cmd.amount) {
+            throw std::runtime_error("Not enough in the source while executing command");
+        }
+        if (&source != &target) {
+            source.moveTo(target, cmd.amount, keepOrder);
+        }
+    }
+
+    // The top crates, left to right
+    std::string message() const {
+        std::string result;
+        for (const auto& stack : stacks) {
+            result.push_back(stack.top());
+        }
+        return result;
+    }
+
+    const std::vector<TStack>& all() const {
+        return stacks;
+    }
+};
+
+#endif // !CrateStacks_h_
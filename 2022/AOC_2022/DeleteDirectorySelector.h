@@ -1,13 +1,13 @@
 #ifndef DeleteDirectorySelector_h_
 #define DeleteDirectorySelector_h_
 
-#include "DirectorySizeComputer.h"
+#include "Filesystem.h"
 
 #include <cassert>
 #include <string>
 #include <optional>
 
-class DeleteDirectorySelector : public DirectorySizeComputer::SizeReporter {
+class DeleteDirectorySelector {
 public:
     static const size_t totalSpace = 70000000;
     static const size_t neededSpace = 30000000;
@@ -22,17 +22,16 @@ public:
 
     std::optional<SelectedDirectory> selected;
 
-    DeleteDirectorySelector(const size_t usedSpace)
-        :usedSpace(usedSpace)
+    // The filesystem's sizes must have been computed
+    DeleteDirectorySelector(const Filesystem& fs)
+        :usedSpace(fs.size(Filesystem::root))
         , needToFree(neededSpace - (totalSpace - usedSpace))
         , selected{}
     {
         assert(needToFree > 0);
-    }
 
-    virtual void report(Filesystem::Directory& d, size_t size) {
-        if (size >= needToFree && (!selected.has_value() || size < selected->size)) {
-            selected = std::make_optional<SelectedDirectory>({ d.name, size });
+        if (const auto dir = fs.smallestDirectory(needToFree); dir.has_value()) {
+            selected = std::make_optional<SelectedDirectory>({ fs.name(*dir), fs.size(*dir) });
         }
     }
 };
@@ -1,43 +1,151 @@
 #include "Filesystem.h"
 
 #include <string>
+#include <stdexcept>
 
 using namespace std;
 
-Filesystem::Filesystem() 
-    :dirstack{}
-, root(Directory{ "/" })
-{
-    cd("/");
+Filesystem::Filesystem() {
+    addNode("/", Kind::Directory, 0);
+    parents[root] = root;
 }
 
-Filesystem::Directory& Filesystem::cd(const string& name) {
+Filesystem::NameId Filesystem::intern(string_view name) {
+    if (const auto iter = nameIds.find(name); iter != nameIds.end()) {
+        return iter->second;
+    }
+
+    const auto id = static_cast<NameId>(nameStrings.size());
+    const auto& stored = nameStrings.emplace_back(name);
+    nameIds.emplace(stored, id);
+    return id;
+}
+
+uint64_t Filesystem::subdirectoryKey(NodeId parent, NameId name) {
+    return static_cast<uint64_t>(parent) << 32 | name;
+}
+
+Filesystem::NodeId Filesystem::addNode(string_view name, Kind kind, size_t size) {
+    if (kinds.size() == none) {
+        throw length_error("Too many filesystem entries");
+    }
+
+    const auto id = static_cast<NodeId>(kinds.size());
+    parents.push_back(current);
+    firstChildren.push_back(none);
+    lastChildren.push_back(none);
+    nextSiblings.push_back(none);
+    names.push_back(intern(name));
+    kinds.push_back(kind);
+    sizes.push_back(size);
+
+    // the root is its own parent and no one's child
+    if (id != root) {
+        if (lastChildren[current] == none) {
+            firstChildren[current] = id;
+        }
+        else {
+            nextSiblings[lastChildren[current]] = id;
+        }
+        lastChildren[current] = id;
+    }
+
+    return id;
+}
+
+Filesystem::NodeId Filesystem::cd(string_view name) {
     if (name == "..") {
-        dirstack.pop();
+        current = parents[current];
     }
     else if (name == "/") {
-        while (!dirstack.empty()) {
-            dirstack.pop();
-        }
-        dirstack.push(&root);
+        current = root;
     }
     else {
-        auto subdirIter = ranges::find_if(dirstack.top()->contents, [&name](const auto& d) { return d->name == name; });
-        auto subdirPrt = static_cast<Directory*>(subdirIter->get());
-        dirstack.push(subdirPrt);
+        const auto nameIter = nameIds.find(name);
+        const auto subdirIter = nameIter == nameIds.end()
+            ? subdirectories.end()
+            : subdirectories.find(subdirectoryKey(current, nameIter->second));
+        if (subdirIter == subdirectories.end()) {
+            throw runtime_error("No directory " + string(name) + " in " + this->name(current));
+        }
+        current = subdirIter->second;
     }
 
-    return *dirstack.top();
+    return current;
 }
 
-void Filesystem::addFile(const string& name, size_t size) {
-    dirstack.top()->contents.push_back(make_unique<File>(name, size));
+void Filesystem::addFile(string_view name, size_t size) {
+    addNode(name, Kind::File, size);
+
+    if (sizesComputed) {
+        for (NodeId dir = current; ; dir = parents[dir]) {
+            sizes[dir] += size;
+            if (dir == root) {
+                break;
+            }
+        }
+    }
 }
 
-void Filesystem::addDir(const string& name) {
-    dirstack.top()->contents.push_back(make_unique<Directory>(name));
+void Filesystem::addDir(string_view name) {
+    const auto key = subdirectoryKey(current, intern(name));
+    if (subdirectories.contains(key)) {
+        return;
+    }
+
+    const auto id = addNode(name, Kind::Directory, 0);
+    subdirectories.emplace(key, id);
 }
 
-void Filesystem::accept(Filesystem::Visitor& v) {
-    dirstack.top()->accept(v);
-}
\ No newline at end of file
+void Filesystem::computeSizes() {
+    for (NodeId id = 0; id < kinds.size(); ++id) {
+        if (kinds[id] == Kind::Directory) {
+            sizes[id] = 0;
+        }
+    }
+
+    // children have higher ids than their parents
+    for (auto id = static_cast<NodeId>(kinds.size()); --id != root;) {
+        sizes[parents[id]] += sizes[id];
+    }
+
+    sizesComputed = true;
+}
+
+size_t Filesystem::size(NodeId node) const {
+    if (kinds[node] == Kind::Directory && !sizesComputed) {
+        throw logic_error("Directory sizes haven't been computed");
+    }
+    return sizes[node];
+}
+
+size_t Filesystem::directorySizeSum(size_t limit) const {
+    if (!sizesComputed) {
+        throw logic_error("Directory sizes haven't been computed");
+    }
+
+    size_t sum = 0;
+    for (size_t id = 0; id < sizes.size(); ++id) {
+        if (kinds[id] == Kind::Directory && sizes[id] <= limit) {
+            sum += sizes[id];
+        }
+    }
+
+    return sum;
+}
+
+optional<Filesystem::NodeId> Filesystem::smallestDirectory(size_t minimumSize) const {
+    if (!sizesComputed) {
+        throw logic_error("Directory sizes haven't been computed");
+    }
+
+    // Backwards so that a subdirectory wins a tie with its parent
+    optional<NodeId> selected;
+    for (auto id = static_cast<NodeId>(sizes.size()); id-- > 0;) {
+        if (kinds[id] == Kind::Directory && sizes[id] >= minimumSize && (!selected || sizes[id] < sizes[*selected])) {
+            selected = id;
+        }
+    }
+
+    return selected;
+}
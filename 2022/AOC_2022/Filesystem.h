@@ -2,74 +2,85 @@
 #define Filesystem_h_
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
-#include <stack>
+#include <deque>
+#include <unordered_map>
+#include <optional>
+#include <cstdint>
+#include <limits>
 
+// Directory tree kept in flat arrays indexed by node id.
+//
+// Nodes are only ever appended and a node is always created after its parent,
+// so walking the ids backwards visits every child before its parent. That gives
+// the directory sizes in a single post-order pass (computeSizes), after which
+// addFile keeps them current by adding to the ancestors of the new file.
 class Filesystem {
 public:
-    //forward declare classes
-    class File;
-    class Directory;
+    using NodeId = std::uint32_t;
+    using NameId = std::uint32_t;
 
-    class Visitor {
-    public:
-        virtual void visit(File&) = 0;
-        virtual void visit(Directory&) = 0;
-    };
+    static constexpr NodeId root = 0;
+    static constexpr NodeId none = std::numeric_limits<NodeId>::max();
 
-    class Entry {
-    public:
-        std::string name;
-        Entry(std::string name)
-            :name(name)
-        {
-        }
-        virtual ~Entry() = default;
-        virtual void accept(Visitor&) = 0;
+    enum class Kind : std::uint8_t {
+        File,
+        Directory
     };
 
-    class File : public Entry {
-    public:
-        size_t size;
+private:
+    // Per node
+    std::vector<NodeId> parents;
+    std::vector<NodeId> firstChildren;
+    std::vector<NodeId> lastChildren;
+    std::vector<NodeId> nextSiblings;
+    std::vector<NameId> names;
+    std::vector<Kind> kinds;
+    // File size for files, total size of the contents for directories once computed
+    std::vector<std::size_t> sizes;
 
-        File(std::string name, size_t size)
-            :Entry(name)
-            , size(size)
-        {}
+    // Interned names, the keys view the strings in the deque
+    std::deque<std::string> nameStrings;
+    std::unordered_map<std::string_view, NameId> nameIds;
 
-        virtual ~File() = default;
-        virtual void accept(Visitor& v) {
-            v.visit(*this);
-        }
-    };
+    // (parent, name) of every directory, for cd
+    std::unordered_map<std::uint64_t, NodeId> subdirectories;
 
-    class Directory : public Entry {
-    public:
-        std::vector<std::unique_ptr<Entry>> contents;
-        Directory(std::string name)
-            :Entry(name)
-            , contents{}
-        {
-        }
-        Directory(Directory&&) = default;
-        virtual ~Directory() = default;
-        virtual void accept(Visitor& v) {
-            v.visit(*this);
-        }
-    };
+    NodeId current = root;
+    bool sizesComputed = false;
 
-    std::stack<Directory*> dirstack;
-    Directory root;
+    NameId intern(std::string_view name);
+    NodeId addNode(std::string_view name, Kind kind, std::size_t size);
+    static std::uint64_t subdirectoryKey(NodeId parent, NameId name);
 
 public:
     Filesystem();
-    Filesystem(Filesystem&& other) = default;
+    // The name table views its own strings
+    Filesystem(const Filesystem&) = delete;
+    Filesystem(Filesystem&&) = default;
+
+    NodeId cd(std::string_view name);
+    void addFile(std::string_view name, std::size_t size);
+    // Adding a directory that already exists is a no-op
+    void addDir(std::string_view name);
+
+    // Post-order pass over all the nodes, directory sizes are valid from here on
+    void computeSizes();
+
+    std::size_t nodeCount() const { return kinds.size(); }
+    NodeId cwd() const { return current; }
+    NodeId parent(NodeId node) const { return parents[node]; }
+    NodeId firstChild(NodeId node) const { return firstChildren[node]; }
+    NodeId nextSibling(NodeId node) const { return nextSiblings[node]; }
+    Kind kind(NodeId node) const { return kinds[node]; }
+    const std::string& name(NodeId node) const { return nameStrings[names[node]]; }
+    std::size_t size(NodeId node) const;
 
-    Directory& cd(const std::string& name);
-    void addFile(const std::string& name, size_t size);
-    void addDir(const std::string& name);
-    void accept(Visitor& v);
+    // Sum of the sizes of the directories no bigger than limit
+    std::size_t directorySizeSum(std::size_t limit) const;
+    // The smallest directory of at least minimumSize
+    std::optional<NodeId> smallestDirectory(std::size_t minimumSize) const;
 };
 
 #endif
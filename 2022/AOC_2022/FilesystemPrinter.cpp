@@ -3,8 +3,6 @@
 #include "printers.h"
 
 #include <iostream>
-#include <ranges>
-#include <algorithm>
 
 using namespace std;
 
@@ -18,13 +16,16 @@ FilesystemPrinter::FilesystemPrinter()
 {
 }
 
-void FilesystemPrinter::visit(Filesystem::File &f) {
-	cout << string(depth * 2, ' ') << "- " << f.name << " (file, size=" << f.size << ")" << endl;
-}
+void FilesystemPrinter::print(const Filesystem& fs, Filesystem::NodeId node) {
+    if (fs.kind(node) == Filesystem::Kind::File) {
+        cout << string(depth * 2, ' ') << "- " << fs.name(node) << " (file, size=" << fs.size(node) << ")" << endl;
+        return;
+    }
 
-void FilesystemPrinter::visit(Filesystem::Directory& d) {
-    cout << string(depth * 2, ' ') << "- " << d.name << " (dir)" << endl;
+    cout << string(depth * 2, ' ') << "- " << fs.name(node) << " (dir)" << endl;
     ++depth;
-    ranges::for_each(d.contents, [this](const auto& d) { d->accept(*this); });
+    for (auto child = fs.firstChild(node); child != Filesystem::none; child = fs.nextSibling(child)) {
+        print(fs, child);
+    }
     --depth;
 }
@@ -3,14 +3,13 @@
 
 #include "Filesystem.h"
 
-class FilesystemPrinter : public Filesystem::Visitor {
+class FilesystemPrinter {
     size_t depth = 0;
 public:
     FilesystemPrinter(size_t depth);
     FilesystemPrinter();
 
-    virtual void visit(Filesystem::File& f);
-    virtual void visit(Filesystem::Directory& d);
+    void print(const Filesystem& fs, Filesystem::NodeId node = Filesystem::root);
 };
 
 #endif
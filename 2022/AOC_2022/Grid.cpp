@@ -1,174 +1,142 @@
 #include "Grid.h"
 #include "SizePoint.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <stdexcept>
+
+namespace {
+    // Below this many trees per thread the threads cost more than they save
+    constexpr size_t minTreesPerThread = 1 << 16;
+
+    // Calls body(i, stack) for every i in [0, count), each thread with its own stack
+    template <typename Body>
+    void parallelFor(size_t count, unsigned threads, size_t treesPerItem, Body body) {
+        std::atomic<size_t> next{ 0 };
+        const size_t blockSize = std::max<size_t>(1, minTreesPerThread / std::max<size_t>(1, treesPerItem));
+
+        const auto worker = [&]() {
+            std::vector<std::uint32_t> stack;
+            for (size_t begin; (begin = next.fetch_add(blockSize)) < count;) {
+                const auto end = std::min(count, begin + blockSize);
+                for (size_t i = begin; i < end; ++i) {
+                    body(i, stack);
+                }
+            }
+        };
 
-Grid::Grid(size_t n, std::function<Grid::Location (const SizePoint&)> locationValueProvider)
-    :n(n)
-    , backingStore{}
-{
-    backingStore.reserve(n * n);
+        const size_t usefulThreads = count * treesPerItem / minTreesPerThread + 1;
+        threads = static_cast<unsigned>(std::clamp<size_t>(threads, 1, usefulThreads));
 
-    for (size_t y = 0; y < n; ++y) {
-        for (size_t x = 0; x < n; ++x) {
-            backingStore.emplace_back(locationValueProvider({x, y}));
+        std::vector<std::jthread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
         }
+        worker();
     }
-}
-
-const Grid::Location& Grid::at(const SizePoint& location) const {
-    assert(location.x >= 0);
-    assert(location.y >= 0);
-    assert(location.x <= n);
-    assert(location.y <= n);
-
-    return backingStore.at(location.y * n + location.x);
-}
-
-Grid::Location& Grid::at(const SizePoint& location) {
-    assert(location.x >= 0);
-    assert(location.y >= 0);
-    assert(location.x <= n);
-    assert(location.y <= n);
-
-    return backingStore.at(location.y * n + location.x);
-}
 
-void Grid::visitTopDownLeftRight(Grid::LocationVisitor callback) {
-    for (size_t y = 0; y < n; ++y) {
-        for (size_t x = 0; x < n; ++x) {
+    // Looks at a line of trees from both ends. visible gets whether the tree is seen
+    // from either end, views the product of the view distances towards both ends.
+    void scanLine(const Grid::Height* line, const size_t length, std::uint8_t* visible, std::uint64_t* views, std::vector<std::uint32_t>& stack) {
+        // Forwards, the stack keeps the trees that aren't hidden behind a taller one
+        stack.clear();
+        for (std::uint32_t i = 0; i < length; ++i) {
+            while (!stack.empty() && line[stack.back()] < line[i]) {
+                stack.pop_back();
+            }
+            visible[i] = stack.empty();
+            views[i] = stack.empty() ? i : i - stack.back();
+            stack.push_back(i);
+        }
 
-            const SizePoint p{ x, y };
-            callback(p, at(p));
+        stack.clear();
+        for (auto i = static_cast<std::uint32_t>(length); i-- > 0;) {
+            while (!stack.empty() && line[stack.back()] < line[i]) {
+                stack.pop_back();
+            }
+            visible[i] |= stack.empty();
+            views[i] *= stack.empty() ? length - 1 - i : stack.back() - i;
+            stack.push_back(i);
         }
     }
 }
 
-void Grid::visitTopDownLeftRight(Grid::ConstLocationVisitor callback) const {
-    for (size_t y = 0; y < n; ++y) {
-        for (size_t x = 0; x < n; ++x) {
-
-            const SizePoint p{ x, y };
-            callback(p, at(p));
-        }
+Grid::Grid(size_t width, size_t height, std::vector<Height> heights)
+    : width(width)
+    , height(height)
+    , heights(std::move(heights))
+    , visible{}
+    , scenicScores{}
+{
+    if (this->heights.size() != width * height) {
+        throw std::invalid_argument("The heights don't fill the grid");
+    }
+    if (width > UINT32_MAX || height > UINT32_MAX) {
+        throw std::length_error("The grid is too wide");
     }
 }
 
-void Grid::visitBottomUpRightLeft(Grid::LocationVisitor callback) {
-    for (size_t shiftedY = n; shiftedY > 0; --shiftedY) {
-        for (size_t shiftedX = n; shiftedX > 0; --shiftedX) {
-            // Use shifted[X/Y] because we can't use the actual x/y on the for
-            const size_t x = shiftedX - 1;
-            const size_t y = shiftedY - 1;
-
-            const SizePoint p{ x, y };
+size_t Grid::index(const SizePoint& location) const {
+    assert(location.x < width);
+    assert(location.y < height);
 
-            callback(p, at(p));
-        }
-    }
+    return location.y * width + location.x;
 }
 
-void Grid::visitBottomUpRightLeft(Grid::ConstLocationVisitor callback) const {
-    for (size_t shiftedY = n; shiftedY > 0; --shiftedY) {
-        for (size_t shiftedX = n; shiftedX > 0; --shiftedX) {
-            // Use shifted[X/Y] because we can't use the actual x/y on the for
-            const size_t x = shiftedX - 1;
-            const size_t y = shiftedY - 1;
-
-            const SizePoint p{ x, y };
-            callback(p, at(p));
-        }
-    }
+Grid::Height Grid::at(const SizePoint& location) const {
+    return heights.at(index(location));
 }
 
+bool Grid::isVisible(const SizePoint& location) const {
+    return visible.at(index(location));
+}
 
-void Grid::computeVisibility() {
-    using std::max;
+std::uint64_t Grid::scenicScore(const SizePoint& location) const {
+    return scenicScores.at(index(location));
+}
 
-    // top->bottom, left->right
+void Grid::computeVisibility(unsigned threads) {
+    const size_t size = width * height;
 
-    visitTopDownLeftRight([this](const SizePoint& loc, Location& current) {
-        if (loc.x > 0) {
+    std::vector<Height> columnHeights(size);
+    parallelFor(height, threads, width, [&](size_t y, auto&) {
+        for (size_t x = 0; x < width; ++x) {
+            columnHeights[x * height + y] = heights[y * width + x];
+        }
+    });
 
-            const auto& left = at({ loc.x - 1, loc.y });
-            current.maxLeft = max(left.maxLeft, left.treeSize);
+    // Rows in the grid's layout, columns in the transposed one
+    std::vector<std::uint8_t> rowVisible(size), columnVisible(size);
+    std::vector<std::uint64_t> rowViews(size), columnViews(size);
 
-            current.viewDistanceLeft = 1;
-        loop_compute_view_distance_left:
-            size_t viewX = loc.x - current.viewDistanceLeft;
-            if (viewX > 0) {
-                const auto& viewTarget = at({ viewX, loc.y });
-                if (current.treeSize > viewTarget.treeSize && viewTarget.viewDistanceLeft > 0) {
-                    current.viewDistanceLeft += viewTarget.viewDistanceLeft;
-                    goto loop_compute_view_distance_left;
-                }
-            }
+    parallelFor(height + width, threads, std::max(width, height), [&](size_t line, auto& stack) {
+        if (line < height) {
+            const auto offset = line * width;
+            scanLine(&heights[offset], width, &rowVisible[offset], &rowViews[offset], stack);
         }
-
-    if (loc.y > 0) {
-        const auto& up = at({ loc.x, loc.y - 1 });
-        current.maxUp = max(up.maxUp, up.treeSize);
-
-        current.viewDistanceUp = 1;
-    loop_compute_view_distance_up:
-        size_t viewY = loc.y - current.viewDistanceUp;
-        if (viewY > 0) {
-            const auto& viewTarget = at({ loc.x, viewY });
-            if (current.treeSize > viewTarget.treeSize && viewTarget.viewDistanceUp > 0) {
-                current.viewDistanceUp += viewTarget.viewDistanceUp;
-                goto loop_compute_view_distance_up;
-            }
+        else {
+            const auto offset = (line - height) * height;
+            scanLine(&columnHeights[offset], height, &columnVisible[offset], &columnViews[offset], stack);
         }
-    }
-        });
-
-    visitBottomUpRightLeft([this](const SizePoint& loc, Location& current) {
-        if (loc.x + 1 != n) {
-            const auto& right = at({ loc.x + 1, loc.y });
-            current.maxRight = max(right.maxRight, right.treeSize);
-
-            current.viewDistanceRight = 1;
-        loop_compute_view_distance_right:
-            size_t viewX = loc.x + current.viewDistanceRight;
-            if (viewX < n - 1) {
-                const auto& viewTarget = at({ viewX, loc.y });
-                if (current.treeSize > viewTarget.treeSize && viewTarget.viewDistanceRight > 0) {
-                    current.viewDistanceRight += viewTarget.viewDistanceRight;
-                    goto loop_compute_view_distance_right;
-                }
-            }
+    });
+
+    visible.resize(size);
+    scenicScores.resize(size);
+    parallelFor(height, threads, width, [&](size_t y, auto&) {
+        for (size_t x = 0; x < width; ++x) {
+            const auto i = y * width + x;
+            const auto transposed = x * height + y;
+            visible[i] = rowVisible[i] | columnVisible[transposed];
+            scenicScores[i] = rowViews[i] * columnViews[transposed];
         }
+    });
+}
 
-    if (loc.y + 1 != n) {
-        const auto& down = at({ loc.x, loc.y + 1 });
-        current.maxDown = max(down.maxDown, down.treeSize);
-
-        current.viewDistanceDown = 1;
-    loop_compute_view_distance_down:
-        size_t viewY = loc.y + current.viewDistanceDown;
-        if (viewY < n - 1) {
-            const auto& viewTarget = at({ loc.x, viewY });
-            if (current.treeSize > viewTarget.treeSize && viewTarget.viewDistanceDown > 0) {
-                current.viewDistanceDown += viewTarget.viewDistanceDown;
-                goto loop_compute_view_distance_down;
-            }
-        }
-    }
-        });
-
-    visitTopDownLeftRight([this](const SizePoint& loc, Location& current) {
-        current.isVisible = loc.x == 0
-        || loc.x == n - 1
-        || loc.y == 0
-        || loc.y == n - 1
-        || current.maxDown < current.treeSize
-        || current.maxUp < current.treeSize
-        || current.maxLeft < current.treeSize
-        || current.maxRight < current.treeSize;
-
-    current.scenicScore = current.viewDistanceLeft
-        * current.viewDistanceRight
-        * current.viewDistanceUp
-        * current.viewDistanceDown;
-        });
-}
\ No newline at end of file
+size_t Grid::visibleCount() const {
+    return std::count(visible.begin(), visible.end(), 1);
+}
+
+std::uint64_t Grid::maxScenicScore() const {
+    return scenicScores.empty() ? 0 : *std::max_element(scenicScores.begin(), scenicScores.end());
+}
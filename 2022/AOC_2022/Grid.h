@@ -2,66 +2,50 @@
 #define Grid_h_
 
 #include "SizePoint.h"
-#include <functional>
+#include "utils.h"
 
 #include <vector>
+#include <cstdint>
+#include <thread>
 #include <ostream>
 
+// Tree heights of a rectangular patch, with visibility and scenic scores.
+//
+// Every row and every column is scanned in both directions with a monotonic
+// stack of the trees that are still in view, which gives both the nearest tree
+// at least as tall (the view distance) and whether the tree is seen from the
+// edge in O(1) amortized per tree. Columns are scanned on a transposed copy of
+// the heights so that both kinds of lines are contiguous.
 class Grid {
 public:
-    class Location {
-    public:
-        typedef short ValueType;
+    using Height = std::uint8_t;
 
-        short treeSize;
-        short maxUp;
-        short maxDown;
-        short maxLeft;
-        short maxRight;
-        bool isVisible;
-        short viewDistanceUp;
-        short viewDistanceDown;
-        short viewDistanceLeft;
-        short viewDistanceRight;
-        long scenicScore;
+    const size_t width;
+    const size_t height;
 
-        Location(short treeSize)
-            :treeSize(treeSize)
-            , maxUp(0)
-            , maxDown(0)
-            , maxLeft(0)
-            , maxRight(0)
-            , isVisible(true)
-            , viewDistanceUp(0)
-            , viewDistanceDown(0)
-            , viewDistanceLeft(0)
-            , viewDistanceRight(0)
-            , scenicScore(0)
-        {
-        }
-    };
+private:
+    // Row major
+    std::vector<Height> heights;
+    std::vector<std::uint8_t> visible;
+    std::vector<std::uint64_t> scenicScores;
 
-    std::vector<Location> backingStore;
-    size_t n;
+    size_t index(const SizePoint& location) const;
 
-    Grid(size_t n,std::function<Location (const SizePoint&)>);
-
-    const Location& at(const SizePoint& location) const;
-    Location& at(const SizePoint& location);
+public:
+    Grid(size_t width, size_t height, std::vector<Height> heights);
 
-    using LocationVisitor = std::function<void(const SizePoint&, Location&)>;
-    using ConstLocationVisitor = std::function<void(const SizePoint&, const Location&)>;
+    Height at(const SizePoint& location) const;
+    bool isVisible(const SizePoint& location) const;
+    std::uint64_t scenicScore(const SizePoint& location) const;
 
-    void visitTopDownLeftRight(LocationVisitor callback);
-    void visitTopDownLeftRight(ConstLocationVisitor callback) const;
-    void visitBottomUpRightLeft(LocationVisitor callback);
-    void visitBottomUpRightLeft(ConstLocationVisitor callback) const;
+    // Rows and columns are split among the threads
+    void computeVisibility(unsigned threads = dayThreads());
 
-    void computeVisibility();
+    size_t visibleCount() const;
+    std::uint64_t maxScenicScore() const;
 
     friend std::ostream& operator<<(std::ostream& os, const Grid& g);
 };
 
 
 #endif
-
@@ -0,0 +1,134 @@
+#include "QueueBenchmark.h"
+#include "../../common/BucketQueue.h"
+
+#include <vector>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <iostream>
+#include <functional>
+
+using namespace std;
+
+namespace {
+    using Cost = uint32_t;
+    using Index = uint32_t;
+
+    constexpr Cost maxWeight = 9;
+    constexpr Cost unreached = numeric_limits<Cost>::max();
+
+    // Cost of entering each cell
+    struct WeightedGrid {
+        size_t side;
+        vector<uint8_t> weights;
+    };
+
+    WeightedGrid randomGrid(size_t side) {
+        WeightedGrid grid{ side, vector<uint8_t>(side * side) };
+        mt19937 engine(static_cast<unsigned>(side));
+        uniform_int_distribution<int> weight(1, maxWeight);
+        for (auto& w : grid.weights) {
+            w = static_cast<uint8_t>(weight(engine));
+        }
+        return grid;
+    }
+
+    template <typename TRelax>
+    void forEachNeighbour(const WeightedGrid& grid, Index current, TRelax relax) {
+        const auto side = grid.side;
+        const auto x = current % side;
+        if (current >= side) {
+            relax(static_cast<Index>(current - side));
+        }
+        if (current + side < grid.weights.size()) {
+            relax(static_cast<Index>(current + side));
+        }
+        if (x > 0) {
+            relax(current - 1);
+        }
+        if (x + 1 < side) {
+            relax(current + 1);
+        }
+    }
+
+    // Shortest distances from the top left corner
+    vector<Cost> bucketQueueDijkstra(const WeightedGrid& grid) {
+        vector<Cost> distances(grid.weights.size(), unreached);
+        BucketQueue<Index, Cost> open(maxWeight);
+
+        distances[0] = 0;
+        open.push(0, 0);
+
+        const auto isStale = [&distances](const auto& entry) { return entry.priority > distances[entry.node]; };
+        while (const auto entry = open.pop(isStale)) {
+            forEachNeighbour(grid, entry->node, [&](Index next) {
+                const auto distance = entry->priority + grid.weights[next];
+                if (distance < distances[next]) {
+                    distances[next] = distance;
+                    open.push(next, distance);
+                }
+            });
+        }
+
+        return distances;
+    }
+
+    vector<Cost> priorityQueueDijkstra(const WeightedGrid& grid) {
+        using Entry = pair<Cost, Index>;
+        vector<Cost> distances(grid.weights.size(), unreached);
+        priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+
+        distances[0] = 0;
+        open.emplace(0, 0);
+
+        while (!open.empty()) {
+            const auto [priority, node] = open.top();
+            open.pop();
+            if (priority > distances[node]) {
+                continue;
+            }
+
+            forEachNeighbour(grid, node, [&](Index next) {
+                const auto distance = priority + grid.weights[next];
+                if (distance < distances[next]) {
+                    distances[next] = distance;
+                    open.emplace(distance, next);
+                }
+            });
+        }
+
+        return distances;
+    }
+
+    template <typename TSearch>
+    pair<vector<Cost>, double> timed(TSearch search, const WeightedGrid& grid) {
+        const auto start = chrono::steady_clock::now();
+        auto distances = search(grid);
+        const chrono::duration<double, milli> duration = chrono::steady_clock::now() - start;
+        return { move(distances), duration.count() };
+    }
+}
+
+bool queueBenchmark(size_t maxSide) {
+    bool agree = true;
+
+    for (size_t side = 100; side <= maxSide; side *= 10) {
+        const auto grid = randomGrid(side);
+
+        const auto [bucketDistances, bucketTime] = timed(bucketQueueDijkstra, grid);
+        const auto [heapDistances, heapTime] = timed(priorityQueueDijkstra, grid);
+        const bool same = bucketDistances == heapDistances;
+        agree = agree && same;
+
+        cout << side << "x" << side
+            << ": BucketQueue " << bucketTime << " ms"
+            << ", std::priority_queue " << heapTime << " ms"
+            << " (x" << heapTime / bucketTime << ")"
+            << ", distance to the far corner " << bucketDistances.back()
+            << (same ? "" : " MISMATCH") << endl;
+    }
+
+    return agree;
+}
@@ -0,0 +1,11 @@
+#ifndef QueueBenchmark_h_
+#define QueueBenchmark_h_
+
+#include <cstddef>
+
+// Times Dijkstra on random weighted square grids, with BucketQueue and with
+// std::priority_queue, from 100x100 up to maxSide x maxSide (10x per step).
+// Returns false when the two searches disagree.
+bool queueBenchmark(std::size_t maxSide);
+
+#endif // !QueueBenchmark_h_
@@ -1,59 +1,77 @@
 #include "Rope.h"
 
-Rope::Rope(const size_t knotCount, const Coords& initialPos)
-	:knots(knotCount, initialPos)
-{
+#include <stdexcept>
+
+namespace {
+	int sign(int value) {
+		return (value > 0) - (value < 0);
+	}
 }
 
+Rope::Rope(const size_t knotCount, const LongCoords& initialPos)
+	:knotCount(knotCount)
+{
+	if (knotCount == 0 || knotCount > maxKnots) {
+		throw std::out_of_range("Unsupported number of knots");
+	}
 
-void Rope::move(const Coords& c) {
-	move(0, first() + c);
+	xs.fill(initialPos.x);
+	ys.fill(initialPos.y);
 }
 
-void Rope::move(size_t i, const Coords& newPos) {
-	//const Coords initialPos = knots[i];
-	knots[i] = newPos;
+size_t Rope::move(const Coords& step) {
+	xs[0] += step.x;
+	ys[0] += step.y;
 
-	// if there is a tail, process the tail head
-	if (i + 1 < knots.size()) {
-		const Coords tail = knots[i + 1];
-		const auto d = newPos - tail;
-		const auto distance = manhattan(newPos, tail);
+	for (size_t i = 1; i < knotCount; ++i) {
+		// Neighbouring knots are at most 2 apart
+		const int dx = static_cast<int>(xs[i - 1] - xs[i]);
+		const int dy = static_cast<int>(ys[i - 1] - ys[i]);
 
-		if (((d.x == 0 || d.y == 0) && distance == 2) || distance >= 3) {
-			int tailX = d.x != 0;
-			int tailY = d.y != 0;
-			if (d.x < 0) {
-				tailX *= -1;
-			}
-			if (d.y < 0) {
-				tailY *= -1;
-			}
-			move(i + 1, tail + Coords{ tailX, tailY });
+		// Touching, including diagonally, leaves this knot and all after it in place
+		if (dx * dx + dy * dy <= 2) {
+			return i;
 		}
+
+		xs[i] += sign(dx);
+		ys[i] += sign(dy);
 	}
+
+	return knotCount;
 }
 
-Coords Rope::first() {
-	return knots.front();
+bool Rope::inLine(const Coords& step) const {
+	for (size_t i = 1; i < knotCount; ++i) {
+		if (xs[i - 1] - xs[i] != step.x || ys[i - 1] - ys[i] != step.y) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Rope::advance(const Coords& step, long long steps) {
+	for (size_t i = 0; i < knotCount; ++i) {
+		xs[i] += step.x * steps;
+		ys[i] += step.y * steps;
+	}
 }
 
-Coords Rope::second() {
-	return knots.at(1);
+size_t Rope::size() const {
+	return knotCount;
 }
 
-Coords Rope::last() {
-	return knots.back();
+LongCoords Rope::knot(size_t i) const {
+	return { xs[i], ys[i] };
 }
 
-Coords Rope::first() const {
-	return knots.front();
+LongCoords Rope::first() const {
+	return knot(0);
 }
 
-Coords Rope::second() const {
-	return knots.at(1);
+LongCoords Rope::second() const {
+	return knot(1);
 }
 
-Coords Rope::last() const {
-	return knots.back();
-}
\ No newline at end of file
+LongCoords Rope::last() const {
+	return knot(knotCount - 1);
+}
@@ -2,26 +2,40 @@
 #define Rope_h_
 
 #include "Coords.h"
-#include <vector>
 
+#include <array>
+#include <cstddef>
+
+// Knots kept as separate x and y arrays of a fixed capacity
 class Rope {
 public:
-	std::vector<Coords> knots;
+	static constexpr size_t maxKnots = 16;
 
+private:
+	std::array<long long, maxKnots> xs{};
+	std::array<long long, maxKnots> ys{};
+	size_t knotCount;
 
-	Rope(const size_t knotCount, const Coords& initialPos);
+public:
+	Rope(const size_t knotCount, const LongCoords& initialPos);
 
-	void move(const Coords& c);
-	void move(size_t i, const Coords& newPos);
+	// Moves the head by one step and lets the knots follow. Returns how many
+	// knots moved, the head included: the rest of the rope stays where it was.
+	size_t move(const Coords& step);
 
-	Coords first();
-	Coords first() const;
+	// Whether every knot is one step behind the one before it. Then each move
+	// by the step moves all the knots by it, so the rope can jump ahead.
+	bool inLine(const Coords& step) const;
+	// Moves all the knots by steps times the step, what as many calls of
+	// move(step) do once the rope is inLine(step)
+	void advance(const Coords& step, long long steps);
 
-	Coords second();
-	Coords second() const;
+	size_t size() const;
+	LongCoords knot(size_t i) const;
 
-	Coords last();
-	Coords last() const;
+	LongCoords first() const;
+	LongCoords second() const;
+	LongCoords last() const;
 };
 
 
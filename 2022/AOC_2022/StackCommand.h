@@ -1,15 +1,16 @@
 #ifndef StackCommand_h_
 #define StackCommand_h_
 
-#include <string>
+#include <cstddef>
 
+// A move with the stacks already resolved to their indices
 class StackCommand {
 public:
-    std::string source;
-    std::string target;
-    int amount;
+    std::size_t source;
+    std::size_t target;
+    std::size_t amount;
 
-    StackCommand(std::string source, std::string target, int amount)
+    StackCommand(std::size_t source, std::size_t target, std::size_t amount)
         :source(source)
         , target(target)
         , amount(amount)
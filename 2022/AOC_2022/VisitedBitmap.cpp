@@ -0,0 +1,196 @@
+#include "VisitedBitmap.h"
+
+#include <algorithm>
+#include <vector>
+#include <bit>
+#include <cstdlib>
+#include <stdexcept>
+
+VisitedBitmap::Tile& VisitedBitmap::tileAt(const TileCoords& t) {
+	// Pointers to the elements stay valid when the map rehashes
+	lastTile = &tiles.try_emplace(t).first->second;
+	lastCoords = t;
+	return *lastTile;
+}
+
+const VisitedBitmap::Tile* VisitedBitmap::findTile(const TileCoords& t) const {
+	const auto iter = tiles.find(t);
+	return iter == tiles.end() ? nullptr : &iter->second;
+}
+
+bool VisitedBitmap::inBitmap(long long x, long long y) const {
+	const auto tile = findTile({ x >> tileShift, y >> tileShift });
+	return tile != nullptr && ((*tile)[y & (tileSide - 1)] >> (x & (tileSide - 1)) & 1);
+}
+
+namespace {
+	// Calls f(from, to) with the part of each run that overlaps [low, high)
+	template <typename TRuns, typename TFunction>
+	void forRunsIn(const TRuns& runs, long long low, long long high, TFunction f) {
+		auto run = runs.upper_bound(low);
+		if (run != runs.begin() && std::prev(run)->second > low) {
+			--run;
+		}
+		for (; run != runs.end() && run->first < high; ++run) {
+			f(std::max(run->first, low), std::min(run->second, high));
+		}
+	}
+}
+
+void VisitedBitmap::addRun(Runs& runs, long long begin, long long end) {
+	auto run = runs.upper_bound(begin);
+	if (run != runs.begin() && std::prev(run)->second >= begin) {
+		--run;
+		begin = run->first;
+		end = std::max(end, run->second);
+		run = runs.erase(run);
+	}
+	while (run != runs.end() && run->first <= end) {
+		end = std::max(end, run->second);
+		run = runs.erase(run);
+	}
+	runs.emplace_hint(run, begin, end);
+}
+
+bool VisitedBitmap::inRuns(const std::map<long long, Runs>& lines, long long line, long long pos) {
+	const auto runs = lines.find(line);
+	if (runs == lines.end()) {
+		return false;
+	}
+
+	const auto run = runs->second.upper_bound(pos);
+	return run != runs->second.begin() && pos < std::prev(run)->second;
+}
+
+void VisitedBitmap::insertRun(const LongCoords& start, const Coords& step, long long length) {
+	if (std::abs(step.x) + std::abs(step.y) != 1) {
+		throw std::invalid_argument("A run goes along a row or a column");
+	}
+
+	if (length < minRunLength) {
+		const LongCoords longStep{ step.x, step.y };
+		LongCoords c = start;
+		for (long long i = 0; i < length; ++i, c = c + longStep) {
+			insert(c);
+		}
+		return;
+	}
+
+	// Kept as [begin, end) whichever way the run goes
+	if (step.y == 0) {
+		const long long begin = step.x > 0 ? start.x : start.x - length + 1;
+		addRun(rowRuns[start.y], begin, begin + length);
+	}
+	else {
+		const long long begin = step.y > 0 ? start.y : start.y - length + 1;
+		addRun(columnRuns[start.x], begin, begin + length);
+	}
+}
+
+bool VisitedBitmap::contains(const LongCoords& c) const {
+	return inBitmap(c.x, c.y) || inRuns(rowRuns, c.y, c.x) || inRuns(columnRuns, c.x, c.y);
+}
+
+size_t VisitedBitmap::crossings() const {
+	// Sweep along x: a row run is active from its begin to its end, and each
+	// column run counts the active rows in its y range. The active rows are
+	// counted in a Fenwick tree over the ys of the row runs.
+	std::vector<long long> ys;
+	for (const auto& [y, runs] : rowRuns) {
+		ys.push_back(y);
+	}
+
+	struct Event {
+		long long x;
+		// Row runs start and end before the column runs at the same x are counted
+		bool query;
+		// The y index and +1/-1 for a row run, the y range for a column run
+		long long a;
+		long long b;
+	};
+	std::vector<Event> events;
+	for (size_t i = 0; i < ys.size(); ++i) {
+		for (const auto& [begin, end] : rowRuns.at(ys[i])) {
+			events.push_back({ begin, false, static_cast<long long>(i), 1 });
+			events.push_back({ end, false, static_cast<long long>(i), -1 });
+		}
+	}
+	for (const auto& [x, runs] : columnRuns) {
+		for (const auto& [begin, end] : runs) {
+			events.push_back({ x, true, begin, end });
+		}
+	}
+	std::ranges::sort(events, [](const Event& lhs, const Event& rhs) {
+		return lhs.x != rhs.x ? lhs.x < rhs.x : lhs.query < rhs.query;
+	});
+
+	std::vector<long long> tree(ys.size() + 1, 0);
+	const auto add = [&tree](size_t index, long long delta) {
+		for (++index; index < tree.size(); index += index & (~index + 1)) {
+			tree[index] += delta;
+		}
+	};
+	// Active rows among the first count ys
+	const auto prefix = [&tree](size_t count) {
+		long long sum = 0;
+		for (; count > 0; count -= count & (~count + 1)) {
+			sum += tree[count];
+		}
+		return sum;
+	};
+
+	size_t result = 0;
+	for (const auto& event : events) {
+		if (event.query) {
+			const auto first = static_cast<size_t>(std::ranges::lower_bound(ys, event.a) - ys.begin());
+			const auto last = static_cast<size_t>(std::ranges::lower_bound(ys, event.b) - ys.begin());
+			result += static_cast<size_t>(prefix(last) - prefix(first));
+		}
+		else {
+			add(static_cast<size_t>(event.a), event.b);
+		}
+	}
+	return result;
+}
+
+size_t VisitedBitmap::size() const {
+	size_t count = 0;
+
+	// The bits that no run covers, a tile at a time
+	for (const auto& [t, tile] : tiles) {
+		const long long x0 = t.x * tileSide;
+		const long long y0 = t.y * tileSide;
+
+		Tile covered{};
+		for (auto line = rowRuns.lower_bound(y0); line != rowRuns.end() && line->first < y0 + tileSide; ++line) {
+			auto& row = covered[line->first - y0];
+			forRunsIn(line->second, x0, x0 + tileSide, [&row, x0](long long from, long long to) {
+				const auto length = to - from;
+				row |= (length == tileSide ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << length) - 1) << (from - x0);
+			});
+		}
+		for (auto line = columnRuns.lower_bound(x0); line != columnRuns.end() && line->first < x0 + tileSide; ++line) {
+			const auto bit = std::uint64_t{ 1 } << (line->first - x0);
+			forRunsIn(line->second, y0, y0 + tileSide, [&covered, bit, y0](long long from, long long to) {
+				for (long long y = from; y < to; ++y) {
+					covered[y - y0] |= bit;
+				}
+			});
+		}
+
+		for (long long row = 0; row < tileSide; ++row) {
+			count += std::popcount(tile[row] & ~covered[row]);
+		}
+	}
+
+	// Then the runs, with the cells on both a row and a column run once
+	for (const auto* lines : { &rowRuns, &columnRuns }) {
+		for (const auto& [line, runs] : *lines) {
+			for (const auto& [begin, end] : runs) {
+				count += static_cast<size_t>(end - begin);
+			}
+		}
+	}
+
+	return count - crossings();
+}
@@ -0,0 +1,81 @@
+#ifndef VisitedBitmap_h_
+#define VisitedBitmap_h_
+
+#include "Coords.h"
+
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Set of cells as bitmaps of 64x64 tiles. Only the tiles with a cell in them
+// exist, so the memory follows the cells and not the area they spread over.
+// Long straight runs of cells are kept as intervals instead of bits.
+class VisitedBitmap {
+	static constexpr int tileShift = 6;
+	static constexpr long long tileSide = 1 << tileShift;
+
+	// One word per row of the tile
+	using Tile = std::array<std::uint64_t, tileSide>;
+
+	struct TileCoords {
+		long long x;
+		long long y;
+
+		bool operator==(const TileCoords&) const = default;
+	};
+
+	struct TileHash {
+		size_t operator()(const TileCoords& t) const {
+			return static_cast<size_t>(t.x * 0x9E3779B97F4A7C15ull ^ t.y);
+		}
+	};
+
+	std::unordered_map<TileCoords, Tile, TileHash> tiles;
+	// Consecutive cells are mostly in the same tile
+	TileCoords lastCoords{};
+	Tile* lastTile = nullptr;
+
+	// Disjoint runs [begin, end) of one line as begin -> end, touching runs
+	// are joined
+	using Runs = std::map<long long, long long>;
+	// The runs along rows by y, along columns by x
+	std::map<long long, Runs> rowRuns;
+	std::map<long long, Runs> columnRuns;
+
+	Tile& tileAt(const TileCoords& t);
+	const Tile* findTile(const TileCoords& t) const;
+	bool inBitmap(long long x, long long y) const;
+
+	static void addRun(Runs& runs, long long begin, long long end);
+	static bool inRuns(const std::map<long long, Runs>& lines, long long line, long long pos);
+	// Cells in both a row run and a column run
+	size_t crossings() const;
+
+public:
+	VisitedBitmap() = default;
+
+	// A copy would keep lastTile pointing into the map of the original
+	VisitedBitmap(const VisitedBitmap&) = delete;
+	VisitedBitmap& operator=(const VisitedBitmap&) = delete;
+
+	void insert(const LongCoords& c) {
+		const TileCoords t{ c.x >> tileShift, c.y >> tileShift };
+		Tile& tile = lastTile != nullptr && lastCoords == t ? *lastTile : tileAt(t);
+		tile[c.y & (tileSide - 1)] |= std::uint64_t{ 1 } << (c.x & (tileSide - 1));
+	}
+
+	// Runs shorter than this go into the bitmap
+	static constexpr long long minRunLength = 64;
+
+	// Inserts length cells, from start on in the direction of the unit step
+	void insertRun(const LongCoords& start, const Coords& step, long long length);
+
+	bool contains(const LongCoords& c) const;
+
+	// Number of cells in the set
+	size_t size() const;
+};
+
+#endif
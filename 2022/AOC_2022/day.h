@@ -3,10 +3,27 @@
 
 #include <string>
 #include <optional>
+#include <chrono>
 
 struct PartialDayResult {
 	std::string description;
 	std::string value;
+	// Time spent computing this part, work shared by both parts is counted in part 1
+	std::chrono::nanoseconds duration{};
+};
+
+// Measures the parts of a solver one after the other
+class PartTimer {
+	std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+public:
+	// Time since the timer was created or since the previous lap
+	std::chrono::nanoseconds lap() {
+		const auto now = std::chrono::steady_clock::now();
+		const auto result = now - last;
+		last = now;
+		return result;
+	}
 };
 
 struct DayResult {
@@ -27,4 +44,7 @@ DayResult day10();
 DayResult day11();
 DayResult day12();
 
+// Checks too slow to run with the day, false when one fails
+bool day9SelfCheck();
+
 #endif
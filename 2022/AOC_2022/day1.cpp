@@ -27,6 +27,7 @@ vector<vector<string>> toGroups(vector<string> input) {
 
 DayResult day1()
 {
+    PartTimer timer;
     const auto fileData = readFile("day_1_input.txt");
 
     const auto groups = toGroups(fileData);
@@ -56,15 +57,17 @@ DayResult day1()
 
     const auto maxSum = std::ranges::max(sums);
     //std::cout << "Max sum: " << maxSum << endl;
+    const auto part1Time = timer.lap();
 
     ranges::sort(sums, ranges::greater());
     // std::cout << sums << endl;
 
     const auto top3Sum = accumulate(sums.begin(), sums.begin() + 3, 0);
     //std::cout << "Sum of top 3: " << top3Sum << endl;
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Max sum", to_string(maxSum)}),
-        make_optional<PartialDayResult>({"Sum of top 3", to_string(top3Sum)})
+        make_optional<PartialDayResult>({"Max sum", to_string(maxSum), part1Time}),
+        make_optional<PartialDayResult>({"Sum of top 3", to_string(top3Sum), part2Time})
     };
 }
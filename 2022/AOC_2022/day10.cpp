@@ -1,112 +1,128 @@
 #include "day.h"
 #include "utils.h"
+#include "ParsingError.h"
 
 #include <iostream>
-#include <functional>
-#include <optional>
-#include <numeric>
-#include <sstream>
-#include "Range.h"
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
-class CPU {
+// The program compiled to the points where X changes. Between two of them
+// nothing happens, so the cycles are never stepped through one by one.
+class Program {
 public:
-	size_t cycle = 0;
-	long X = 1;
-
-	size_t targetCycle = 20;
-	optional<function<void(const CPU&)>> cycleReporter = nullopt;
-	optional<function<void(const CPU&)>> signalReporter = nullopt;
-
-	void execute(const string& command) {
-		string opcode;
-
-		tick();
-		if (command == "noop") {
-			// no-op
-		}
-		else if (command.starts_with("addx ")) {
-			int param = atoi(command.data() + 5);
-			tick();
-
-			X += param;
-		}
-	}
-
-	long signalStrength() const {
-		return static_cast<long>(cycle) * X;
-	}
+	struct XChange {
+		// X has the value from the cycle after this one on
+		size_t cycle;
+		long x;
+	};
 
-	void tick() {
-		++cycle;
+private:
+	// Sorted by cycle, starts with the initial X
+	vector<XChange> tape{ { 0, 1 } };
+	size_t cycles = 0;
 
-		if (cycleReporter.has_value()) {
-			cycleReporter.value()(*this);
-		}
-
-		if (targetCycle == cycle) {
-			handleTargetCycleReached();
+public:
+	Program(const LineView& lines) {
+		for (const auto line : lines) {
+			if (line == "noop") {
+				cycles += 1;
+			}
+			else if (line.starts_with("addx ")) {
+				long param = 0;
+				if (from_chars(line.data() + 5, line.data() + line.size(), param).ec != errc()) {
+					throw ParsingError("Bad addx parameter: " + string(line));
+				}
+				cycles += 2;
+				tape.push_back({ cycles, tape.back().x + param });
+			}
+			else {
+				throw ParsingError("Unknown instruction: " + string(line));
+			}
 		}
 	}
 
-	void registerCycleReporter(function<void(const CPU&)> reporter) {
-		cycleReporter = reporter;
-	}
-	void clearCycleReporter() {
-		cycleReporter = nullopt;
+	// Number of cycles the program runs for
+	size_t length() const {
+		return cycles;
 	}
 
-	void registerSignalReporter(function<void(const CPU&)> reporter) {
-		signalReporter = reporter;
+	const vector<XChange>& changes() const {
+		return tape;
 	}
-	void clearSignalReporter() {
-		signalReporter = nullopt;
-	}
-
-	void handleTargetCycleReached() {
-		targetCycle += 40;
+};
 
-		if (signalReporter.has_value()) {
-			// const auto ss = signalStrength();
-			signalReporter.value()(*this);
+// Signal strengths during first, first + period, ... up to the end of the
+// program. The samples and the tape are both in cycle order, so one walk
+// over them does.
+vector<long> signalStrengths(const Program& program, size_t first = 20, size_t period = 40) {
+	vector<long> result;
+	const auto& tape = program.changes();
+
+	size_t current = 0;
+	for (size_t cycle = first; cycle <= program.length(); cycle += period) {
+		while (current + 1 < tape.size() && tape[current + 1].cycle < cycle) {
+			++current;
 		}
-
+		result.push_back(static_cast<long>(cycle) * tape[current].x);
 	}
-};
+
+	return result;
+}
 
 class CRT {
 public:
-	static constexpr const size_t lines = 6;
-	static constexpr const size_t columns = 40;
+	const size_t lines;
+	const size_t columns;
 
 	vector<char> framebuffer;
 
-	CRT()
-		:framebuffer(lines * columns, ' ')
+	CRT(size_t lines = 6, size_t columns = 40)
+		: lines(lines)
+		, columns(columns)
+		, framebuffer(lines * columns, ' ')
 	{
 	}
 
-	void samplePixel(const CPU& cpu) {
-		const auto fbIndex = cpu.cycle - 1;
-		const auto linePixelPos = fbIndex % columns;
-
-		bool isLit = Range(cpu.X - 1, cpu.X + 1).contains(linePixelPos);
-
- 		if (isLit) {
-			framebuffer.at(fbIndex) = '#';
+	// Draws the pixels a span at a time: X is the same from one change to the
+	// next, so on each scanline the pixels it covers are lit where they meet
+	// the sprite
+	void render(const Program& program) {
+		const auto& tape = program.changes();
+		const auto pixels = min(program.length(), framebuffer.size());
+
+		for (size_t i = 0; i < tape.size(); ++i) {
+			// The pixel of cycle c is c - 1
+			const size_t begin = tape[i].cycle;
+			const size_t end = min(i + 1 < tape.size() ? tape[i + 1].cycle : program.length(), pixels);
+			const long spriteBegin = tape[i].x - 1;
+			const long spriteEnd = tape[i].x + 2;
+
+			for (size_t pos = begin; pos < end;) {
+				const size_t lineStart = pos - pos % columns;
+				const size_t spanEnd = min(end, lineStart + columns);
+
+				const long litBegin = max(spriteBegin, static_cast<long>(pos - lineStart));
+				const long litEnd = min(spriteEnd, static_cast<long>(spanEnd - lineStart));
+				if (litBegin < litEnd) {
+					fill(framebuffer.begin() + lineStart + litBegin, framebuffer.begin() + lineStart + litEnd, '#');
+				}
+
+				pos = spanEnd;
+			}
 		}
 	}
 
-	string frame() {
+	string frame() const {
 		string frame;
-		frame.reserve(lines * columns);
+		frame.reserve(lines * (columns + 1));
 
-		vector<char>::const_iterator fbIter = framebuffer.begin();
 		for (size_t line = 0; line < lines; ++line) {
-			for (size_t column = 0; column < columns; ++column) {
-				frame.push_back(*fbIter++);
-			}
+			frame.append(framebuffer.begin() + line * columns, framebuffer.begin() + (line + 1) * columns);
 			frame.push_back('\n');
 		}
 
@@ -114,36 +130,22 @@ public:
 	}
 };
 
-#include <algorithm>
-#include <ranges>
+#include <numeric>
 
 DayResult day10() {
-	const auto lines = readFile("day_10_input.txt");
-	CPU cpu;
-	CRT crt;
-
-	vector<long> signalHistory{};
+	PartTimer timer;
+	const Program program(LineView("day_10_input.txt"));
 
-	// register hooks
-	cpu.registerSignalReporter([&signalHistory](const CPU& lambdaCPU) {
-		signalHistory.push_back(lambdaCPU.signalStrength());
-	});
+	const auto signals = signalStrengths(program);
+	const long signal6Sum = accumulate(signals.cbegin(), signals.cbegin() + min<size_t>(6, signals.size()), 0l);
+	const auto part1Time = timer.lap();
 
-	cpu.registerCycleReporter([&crt](const auto& lambdaCPU) {
-		crt.samplePixel(lambdaCPU);
-	});
-
-
-	// execute commands
-	ranges::for_each(lines, [&cpu](const auto line) {
-		cpu.execute(line);
-	});
-
-	// sample results
-	size_t signal6Sum = accumulate(signalHistory.cbegin(), signalHistory.cbegin() + 6, 0l);
+	CRT crt;
+	crt.render(program);
+	const auto part2Time = timer.lap();
 
 	return {
-		make_optional<PartialDayResult>({"Signal strength sum", to_string(signal6Sum)}),
-		make_optional<PartialDayResult>({"CRT frame", "\n" + crt.frame()}),
+		make_optional<PartialDayResult>({"Signal strength sum", to_string(signal6Sum), part1Time}),
+		make_optional<PartialDayResult>({"CRT frame", "\n" + crt.frame(), part2Time}),
 	};
 }
@@ -1,32 +1,51 @@
 #include "day.h"
+#include "utils.h"
 
 #include "ParsingError.h"
 
 #include <iostream>
-#include <queue>
-#include <deque>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <string>
+#include <string_view>
 #include <charconv>
 #include <numeric>
+#include <vector>
+#include <variant>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <limits>
 
 using namespace std;
 
+// The operations of the notes, compiled to one of three forms
+struct AddConstant {
+	unsigned long long value;
+	unsigned long long operator()(unsigned long long old) const { return old + value; }
+};
+
+struct MultiplyByConstant {
+	unsigned long long value;
+	unsigned long long operator()(unsigned long long old) const { return old * value; }
+};
+
+struct Square {
+	unsigned long long operator()(unsigned long long old) const { return old * old; }
+};
+
+using Operation = variant<AddConstant, MultiplyByConstant, Square>;
+
 class Monkey {
 public:
 	int id;
-	deque<unsigned long long> items;
+	vector<unsigned long long> items;
 
-	unsigned long long lhs;
-	unsigned long long rhs;
-	char op;
+	Operation operation;
 
 	unsigned long long testDivider;
 	int trueTarget;
 	int falseTarget;
-
-	unsigned long long itemInspections = 0;
 };
 
 ostream& operator<<(ostream& os, const Monkey& m) {
@@ -45,7 +64,16 @@ ostream& operator<<(ostream& os, const Monkey& m) {
 	}
 	os << endl;
 
-	os << "  Operation: " << m.lhs << " " << m.op << " " << m.rhs << endl;
+	os << "  Operation: new = old ";
+	if (const auto add = get_if<AddConstant>(&m.operation)) {
+		os << "+ " << add->value << endl;
+	}
+	else if (const auto multiply = get_if<MultiplyByConstant>(&m.operation)) {
+		os << "* " << multiply->value << endl;
+	}
+	else {
+		os << "* old" << endl;
+	}
 	os << "  Test: divisible by " << m.testDivider << endl;
 	os << "    If true: throw to monkey " << m.trueTarget << endl;
 	os << "    If false: throw to monkey " << m.falseTarget << endl;
@@ -53,193 +81,321 @@ ostream& operator<<(ostream& os, const Monkey& m) {
 	return os;
 }
 
-template <class _Elem, class _Traits>
-basic_istream<_Elem, _Traits>& operator>>(basic_istream<_Elem, _Traits>& is, const string&& pin) {
-	string input;
-	is >> input;
-	if (pin != input) {
-		throw ParsingError("The input [" + input + "] does not equal [" + pin + "]");
+// Reads the notes in one pass over the text, token by token
+class NotesReader {
+	string_view text;
+	size_t pos = 0;
+
+	void skipSpaces() {
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) {
+			++pos;
+		}
 	}
 
-	return is;
-}
+	[[noreturn]] void fail(const string& expected) const {
+		const auto context = text.substr(pos, text.find('\n', pos) - pos);
+		throw ParsingError("Expected " + expected + " at [" + string(context) + "]");
+	}
 
-Monkey parseMonkey(ifstream& infile) {
-	Monkey result;
+public:
+	NotesReader(string_view text)
+		: text(text)
+	{
+	}
 
-	infile >> "Monkey" >> result.id >> ":";
+	bool atEnd() {
+		skipSpaces();
+		return pos == text.size();
+	}
 
-	char numbers[1024];
-	infile >> "Starting" >> "items:";
+	bool accept(string_view token) {
+		skipSpaces();
+		if (text.substr(pos, token.size()) != token) {
+			return false;
+		}
+		pos += token.size();
+		return true;
+	}
 
-	infile.getline(numbers, 1023, '\n');
-	istringstream iss(numbers);
-	while (iss && !iss.eof()) {
-		if (!result.items.empty()) {
-			iss >> ",";
+	void expect(string_view token) {
+		if (!accept(token)) {
+			fail("[" + string(token) + "]");
 		}
-		int value;
-		iss >> value;
-		result.items.push_back(value);
 	}
 
-	string lhs, rhs;
-	char op;
+	template <typename T>
+	T number() {
+		skipSpaces();
+		T value{};
+		const auto [ptr, ec] = from_chars(text.data() + pos, text.data() + text.size(), value);
+		if (ec != errc()) {
+			fail("a number");
+		}
+		pos = ptr - text.data();
+		return value;
+	}
 
-	infile >> "Operation:" >> "new" >> "=" >> lhs >> op >> rhs;
-	if (lhs == "old") {
-		result.lhs = 0;
+	// "old" or a number, nullopt for old
+	optional<unsigned long long> operand() {
+		if (accept("old")) {
+			return nullopt;
+		}
+		return number<unsigned long long>();
 	}
-	else if(const auto res = from_chars(lhs.data(), lhs.data() + lhs.size(), result.lhs); res.ptr != lhs.data() + lhs.size()) {
-		throw ParsingError("[" + lhs + "] is not trivially converted to a number");
+};
+
+Operation parseOperation(NotesReader& reader) {
+	reader.expect("Operation:");
+	reader.expect("new");
+	reader.expect("=");
+	const auto lhs = reader.operand();
+	const bool add = reader.accept("+");
+	if (!add) {
+		reader.expect("*");
 	}
+	const auto rhs = reader.operand();
 
-	if (rhs == "old") {
-		result.lhs = 0;
+	if (lhs.has_value() && rhs.has_value()) {
+		throw ParsingError("The operation doesn't depend on the old value");
 	}
-	else if (const auto res = from_chars(rhs.data(), rhs.data() + rhs.size(), result.lhs); res.ptr != rhs.data() + rhs.size()) {
-		throw ParsingError("[" + rhs + "] is not trivially converted to a number");
+	if (!lhs.has_value() && !rhs.has_value()) {
+		// old + old is old * 2
+		return add ? Operation{ MultiplyByConstant{ 2 } } : Operation{ Square{} };
 	}
-	result.op = op;
 
-	infile >> "Test:" >> "divisible" >> "by" >> result.testDivider;
-	infile >> "If" >> "true:" >> "throw" >> "to" >> "monkey" >> result.trueTarget;
-	infile >> "If" >> "false:" >> "throw" >> "to" >> "monkey" >> result.falseTarget;
+	const auto constant = lhs.has_value() ? *lhs : *rhs;
+	return add ? Operation{ AddConstant{ constant } } : Operation{ MultiplyByConstant{ constant } };
+}
+
+Monkey parseMonkey(NotesReader& reader) {
+	Monkey result;
+
+	reader.expect("Monkey");
+	result.id = reader.number<int>();
+	reader.expect(":");
+
+	reader.expect("Starting");
+	reader.expect("items:");
+	do {
+		result.items.push_back(reader.number<unsigned long long>());
+	} while (reader.accept(","));
+
+	result.operation = parseOperation(reader);
+
+	reader.expect("Test:");
+	reader.expect("divisible");
+	reader.expect("by");
+	result.testDivider = reader.number<unsigned long long>();
+
+	for (const auto outcome : { "true:", "false:" }) {
+		reader.expect("If");
+		reader.expect(outcome);
+		reader.expect("throw");
+		reader.expect("to");
+		reader.expect("monkey");
+		(outcome[0] == 't' ? result.trueTarget : result.falseTarget) = reader.number<int>();
+	}
 
 	return result;
 }
 
-bool hasInput(ifstream& is) {
-	while (is) {
-		const auto ch = is.get();
-		if (ch == istream::traits_type::eof()) {
-			return false;
-		}
-		if (!isspace(ch)) {
-			is.putback(ch);
-			return true;
+vector<Monkey> parseMonkeys(string filename) {
+	const LineView notes(filename);
+	NotesReader reader(notes.contents());
+
+	vector<Monkey> result;
+	while (!reader.atEnd()) {
+		result.push_back(parseMonkey(reader));
+	}
+
+	for (const auto& monkey : result) {
+		const auto validTarget = [&](int target) {
+			return 0 <= target && target < static_cast<int>(result.size()) && target != monkey.id;
+		};
+		if (monkey.id != &monkey - result.data() || monkey.testDivider == 0 || !validTarget(monkey.trueTarget) || !validTarget(monkey.falseTarget)) {
+			throw ParsingError("Inconsistent notes for monkey " + to_string(monkey.id));
 		}
 	}
-	return false;
+
+	return result;
 }
 
-vector<Monkey> parseMonkeys(string filename) {
-	vector<Monkey> result;
-	ifstream infile(filename);
-	while (infile && hasInput(infile)) {
-		// cout << "Reading monkey " << result.size() << endl;
-		result.push_back(parseMonkey(infile));
+// Without relief the worries are kept below the common multiple of the test
+// divisors, which has to be small enough for the square of a worry to fit
+constexpr unsigned long long maxCommonMultiplier = 1ull << 32;
+
+unsigned long long commonMultiple(const vector<Monkey>& monkeys) {
+	unsigned long long result = 1;
+	for (const auto& monkey : monkeys) {
+		const auto factor = monkey.testDivider / gcd(result, monkey.testDivider);
+		if (result > maxCommonMultiplier / factor) {
+			throw ParsingError("The test divisors have a common multiple over 2^32");
+		}
+		result *= factor;
 	}
-	
 	return result;
 }
 
-DayResult day11() {
-	unsigned long long monkeyBusiness[2] = {};
-	long roundsPerPart[2] = {20, 10000};
-
-	for (int part = 1; part <= 2; ++part) {
-
-		auto monkeys = parseMonkeys("day_11_input.txt");
-		auto commonMultiplier = accumulate(monkeys.cbegin(), monkeys.cend(), monkeys.cbegin()->testDivider, [](const unsigned long long accumulated, const Monkey& rhs) {
-			return lcm(accumulated, rhs.testDivider);
-			});
-		// cout << "commonMultiplier : " << commonMultiplier << endl;
-
-		// process rounds
-		for (int round = 1; round <= roundsPerPart[part-1]; ++round) {
-			for (Monkey& monkey : monkeys) {
-				//cout << monkey << endl;
-
-				// cout << "Monkey " << monkey.id << endl;
-
-				for (auto item : monkey.items) {
-					//cout << "  Monkey inspects an item with a worry level of " << item << endl;
-					++monkey.itemInspections;
-
-
-					switch (monkey.op) {
-					case '*':
-						item = (monkey.lhs ? monkey.lhs : item) * (monkey.rhs ? monkey.rhs : item);
-						//cout << "    Worry level is multiplied by " << rhsValue << " to " << item << '.' << endl;
-						break;
-					case '+':
-						item = (monkey.lhs ? monkey.lhs : item) + (monkey.rhs ? monkey.rhs : item);
-						//cout << "    Worry level is increased by " << rhsValue << " to " << item << '.' << endl;
-						break;
-					default:
-						throw runtime_error(string(1, monkey.op) + " is not a valid operator");
-					}
+// Items never affect each other: where an item goes only depends on its own
+// worry level and the monkey holding it. So every item is followed on its own,
+// through the rounds, as a (monkey, worry) state machine.
+class ItemSimulator {
+public:
+	struct ItemState {
+		int monkey;
+		unsigned long long worry;
+	};
 
-					if (part == 1) {
-						item /= 3;
-						//cout << "    Monkey gets bored with item.Worry level is divided by 3 to " << item << '.' << endl;
-					}
-					else {
-						item %= commonMultiplier;
-					}
+private:
+	const vector<Monkey>& monkeys;
+	// Part 1 divides the worry by 3 after each inspection, which isn't periodic
+	const bool relieved;
+	// Keeps the worry small without changing any divisibility test
+	const unsigned long long commonMultiplier;
+	// The operations of the monkeys, with the constants reduced by the common
+	// multiplier without relief so that they don't overflow either
+	vector<Operation> operations;
+
+	// One round for the item. A monkey throwing to a monkey after it in the order
+	// keeps the item in the same round, throwing back ends the item's round.
+	ItemState round(ItemState item, vector<unsigned long long>& inspections) const {
+		while (true) {
+			const Monkey& monkey = monkeys[item.monkey];
+			++inspections[item.monkey];
+
+			item.worry = visit([worry = item.worry](const auto& operation) { return operation(worry); }, operations[item.monkey]);
+			item.worry = relieved ? item.worry / 3 : item.worry % commonMultiplier;
+
+			const int target = item.worry % monkey.testDivider == 0 ? monkey.trueTarget : monkey.falseTarget;
+			const bool nextRound = target <= item.monkey;
+			item.monkey = target;
+			if (nextRound) {
+				return item;
+			}
+		}
+	}
 
-					int targetMonkey = item % monkey.testDivider == 0 ? monkey.trueTarget : monkey.falseTarget;
+public:
+	ItemSimulator(const vector<Monkey>& monkeys, bool relieved)
+		: monkeys(monkeys)
+		, relieved(relieved)
+		, commonMultiplier(relieved ? 1 : commonMultiple(monkeys))
+	{
+		// The cycle detection keys are monkey * commonMultiplier + worry
+		if (monkeys.size() > numeric_limits<unsigned long long>::max() / commonMultiplier) {
+			throw ParsingError("Too many monkeys");
+		}
 
-					//cout << "    Item with worry level " << item << " is thrown to monkey " << targetMonkey << '.' << endl;
-					monkeys[targetMonkey].items.push_back(item);
-				}
-				monkey.items.clear();
+		for (const auto& monkey : monkeys) {
+			operations.push_back(monkey.operation);
+			if (relieved) {
+				continue;
+			}
+			if (const auto add = get_if<AddConstant>(&operations.back())) {
+				add->value %= commonMultiplier;
+			}
+			else if (const auto multiply = get_if<MultiplyByConstant>(&operations.back())) {
+				multiply->value %= commonMultiplier;
 			}
+		}
+	}
+
+	// Adds the inspections of the item over the rounds. Without relief the state
+	// space is finite, so once the state at the start of a round repeats the
+	// remaining rounds are whole cycles plus a part of one.
+	void simulate(ItemState item, const unsigned long long rounds, vector<unsigned long long>& inspections) const {
+		if (!relieved) {
+			item.worry %= commonMultiplier;
+		}
+
+		// state at the start of a round -> round
+		unordered_map<unsigned long long, unsigned long long> seen;
 
-			/*
-			cout << "After round " << round << ", the monkeys are holding items with these worry levels:" << endl;
-			for (const auto& monkey : monkeys) {
-				cout << "Monkey " << monkey.id << ":";
-				bool notFirst = false;
-				for (const auto item : monkey.items) {
-					if (notFirst) {
-						cout << ',';
+		for (unsigned long long r = 0; r < rounds; ++r) {
+			if (!relieved) {
+				const auto key = item.monkey * commonMultiplier + item.worry;
+				const auto [iter, inserted] = seen.try_emplace(key, r);
+				if (!inserted) {
+					const auto period = r - iter->second;
+					const auto remaining = rounds - r;
+
+					vector<unsigned long long> cycleInspections(monkeys.size());
+					for (unsigned long long i = 0; i < period; ++i) {
+						item = round(item, cycleInspections);
+					}
+					for (size_t m = 0; m < monkeys.size(); ++m) {
+						inspections[m] += cycleInspections[m] * (remaining / period);
+					}
+
+					// back at the same state after the cycle
+					for (unsigned long long i = 0; i < remaining % period; ++i) {
+						item = round(item, inspections);
 					}
-					cout << ' ' << item;
-					notFirst = true;
+					return;
 				}
-				cout << endl;
 			}
-			cout << endl;
-			*/
-			/*
-			if (round == 1 or round == 20 or round % 1000 == 0) {
-				cout << "== After round " << round << " ==" << endl;
-				for (const auto& monkey : monkeys) {
-					cout << "Monkey " << monkey.id << " inspected items " << monkey.itemInspections << " times." << endl;
-				}
-				cout << endl;
+
+			item = round(item, inspections);
+		}
+	}
+
+	// Inspections per monkey after the rounds, with the items split among the threads
+	vector<unsigned long long> inspections(const unsigned long long rounds, unsigned threads = dayThreads()) const {
+		vector<ItemState> items;
+		for (int m = 0; m < static_cast<int>(monkeys.size()); ++m) {
+			for (const auto worry : monkeys[m].items) {
+				items.push_back({ m, worry });
 			}
-			*/
 		}
 
+		threads = clamp<unsigned>(threads, 1, static_cast<unsigned>(max<size_t>(1, items.size())));
+		vector<vector<unsigned long long>> perThread(threads, vector<unsigned long long>(monkeys.size()));
+		atomic<size_t> next{ 0 };
+		{
+			const auto worker = [&](unsigned t) {
+				for (size_t i; (i = next++) < items.size();) {
+					simulate(items[i], rounds, perThread[t]);
+				}
+			};
 
-		const Monkey* maxMonkey = &monkeys[0];
-		for (const auto& monkey : monkeys) {
-			if (monkey.itemInspections > maxMonkey->itemInspections) {
-				maxMonkey = &monkey;
+			vector<jthread> pool;
+			for (unsigned t = 1; t < threads; ++t) {
+				pool.emplace_back(worker, t);
 			}
+			worker(0);
 		}
 
-		const Monkey* secondMax = maxMonkey == &monkeys[0] ? &monkeys[1] : &monkeys[0];
-		for (const auto& monkey : monkeys) {
-			if (maxMonkey != &monkey && monkey.itemInspections > secondMax->itemInspections) {
-				secondMax = &monkey;
+		vector<unsigned long long> result(monkeys.size());
+		for (const auto& counts : perThread) {
+			for (size_t m = 0; m < result.size(); ++m) {
+				result[m] += counts[m];
 			}
 		}
+		return result;
+	}
+};
 
-		/*
-		cout << "Max monkey: " << maxMonkey->id << " with value << " << maxMonkey->itemInspections << endl;
-		cout << "Second monkey: " << secondMax->id << " with value << " << secondMax->itemInspections << endl;
-		cout << endl;
-		*/
-
-		monkeyBusiness[part-1] = maxMonkey->itemInspections * secondMax->itemInspections;
+// Product of the two highest inspection counts
+unsigned long long monkeyBusiness(vector<unsigned long long> inspections) {
+	if (inspections.size() < 2) {
+		throw runtime_error("Not enough monkeys");
 	}
+	partial_sort(inspections.begin(), inspections.begin() + 2, inspections.end(), greater());
+	return inspections[0] * inspections[1];
+}
+
+DayResult day11() {
+	PartTimer timer;
+	const auto monkeys = parseMonkeys("day_11_input.txt");
+
+	const auto initialBusiness = monkeyBusiness(ItemSimulator(monkeys, true).inspections(20));
+	const auto part1Time = timer.lap();
+
+	const auto secondBusiness = monkeyBusiness(ItemSimulator(monkeys, false).inspections(10000));
+	const auto part2Time = timer.lap();
 
 	return {
-		make_optional<PartialDayResult>({"Initial monkey business", to_string(monkeyBusiness[0])}),
-		make_optional<PartialDayResult>({"Second monkey business", to_string(monkeyBusiness[1])})
+		make_optional<PartialDayResult>({"Initial monkey business", to_string(initialBusiness), part1Time}),
+		make_optional<PartialDayResult>({"Second monkey business", to_string(secondBusiness), part2Time})
 	};
-}
\ No newline at end of file
+}
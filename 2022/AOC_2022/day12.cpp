@@ -5,414 +5,238 @@
 #include "printers.h"
 
 #include <iostream>
-#include <unordered_set>
-#include <queue>
 #include <stdexcept>
-#include <map>
-#include <unordered_map>
-#include <utility>
-#include <set>
-#include <type_traits>
+#include <vector>
+#include <string>
+#include <span>
+#include <limits>
 #include <algorithm>
-#include <functional>
+#include <cstdint>
 
 using namespace std;
 
-bool trace = false;
-
-enum class Direction {
-    Up,
-    Down,
-    Left,
-    Right
-};
-
-Coords to_Coords(const Direction& d) {
-    switch (d) {
-    case Direction::Up: return Up;
-    case Direction::Down: return Down;
-    case Direction::Left: return Left;
-    case Direction::Right: return Right;
-    }
-}
-
-Direction to_Direction(const Coords& c) {
-    if (c == Up) {
-        return Direction::Up;
-    }
-    else if (c == Down) {
-        return Direction::Down;
-    }
-    else if (c == Left) {
-        return Direction::Left;
-    }
-    else if (c == Right) {
-        return Direction::Right;
-    }
-}
-
-
 class ElevationGrid {
 public:
-    vector<vector<char>> elevation;
-    Coords start;
-    Coords goal;
-    bool forwardSearch = true;
-
-    ElevationGrid(vector<string> input) {
-        elevation.reserve(input.size());
-
-        int y = 0;
-        int x = 0;
+    using Index = uint32_t;
+    static constexpr Index noIndex = numeric_limits<Index>::max();
+
+    size_t width = 0;
+    size_t height = 0;
+    // Row major
+    vector<char> elevation;
+    Index start = noIndex;
+    Index goal = noIndex;
+
+    ElevationGrid(const LineView& input) {
+        height = input.size();
+        width = input.empty() ? 0 : input[0].length();
+        if (width * height >= noIndex) {
+            throw runtime_error("The grid is too big");
+        }
+        elevation.reserve(width * height);
 
         for (const auto line : input) {
-            vector<char> row;
-            row.reserve(line.length());
+            if (line.length() != width) {
+                throw runtime_error("The rows of the grid have different lengths");
+            }
 
             for (const auto ch : line) {
                 if (ch == 'S') [[unlikely]] {
-                    start = Coords(x, y);
-                    row.push_back('a');
+                    start = static_cast<Index>(elevation.size());
+                    elevation.push_back('a');
                 }
                 else if (ch == 'E') [[unlikely]] {
-                    goal = Coords(x, y);
-                    row.push_back('z');
+                    goal = static_cast<Index>(elevation.size());
+                    elevation.push_back('z');
                 }
-                else{
-                    row.push_back(ch); 
+                else {
+                    elevation.push_back(ch);
                 }
-
-                ++x;
             }
-            elevation.push_back(move(row));
-            ++y;
-            x = 0;
         }
-    }
 
-    auto at(const Coords& pos) const {
-        return elevation.at(pos.y).at(pos.x);
+        if (start == noIndex || goal == noIndex) {
+            throw runtime_error("The grid has no start or goal");
+        }
     }
 
-    bool isValid(const Coords& pos) const {
-        return 0 <= pos.y && pos.y < elevation.size() && 0 <= pos.x && pos.x < elevation.at(pos.y).size();
+    Coords coords(Index index) const {
+        return Coords(static_cast<int>(index % width), static_cast<int>(index / width));
     }
 
-    virtual bool allowTransition(const Coords& from, const Direction dir) const {
-        if (!isValid(from)) {
-            return false;
-        }
-        const auto elevationFrom = at(from);
-
-        const auto to = from + to_Coords(dir);
-        if (!isValid(to)) {
-            return false;
-        }
-        const auto elevationTo = at(to);
-
-        if (forwardSearch) {
-            const auto d = elevationTo - elevationFrom;
-            return d <= 1;
-        }
-        else {
-            const auto d = elevationFrom - elevationTo;
-            return d <= 1;
-        }
+    size_t size() const {
+        return elevation.size();
     }
 };
 
-
-class Step {
+// Breadth first search over the grid, every step costs 1 so a FIFO frontier
+// visits the cells in distance order. Distances and parents are dense arrays
+// over the cells, the path itself is only built when asked for.
+class ElevationSearch {
 public:
-    Coords location;
-    Direction dir;
-};
-
-class Path {
-    vector<Coords> steps;
-public:
-
-    Path(const Coords& head)
-        :steps{ head }
-    {
-    }
-
-    auto head() const {
-        return steps.back();
-    }
+    using Index = ElevationGrid::Index;
+    static constexpr uint32_t unreached = numeric_limits<uint32_t>::max();
+
+    enum class Direction {
+        // Climb at most one up
+        Forward,
+        // Walk the forward steps backwards, descend at most one
+        Reverse
+    };
 
-    auto tail() const {
-        return steps.back();
-    }
+private:
+    const ElevationGrid& grid;
+    const Direction direction;
+    vector<uint32_t> distances;
+    vector<Index> parents;
+    vector<Index> frontier;
 
-    auto length() const {
-        return steps.size() - 1;
+    bool allowTransition(Index from, Index to) const {
+        const auto d = direction == Direction::Forward
+            ? grid.elevation[to] - grid.elevation[from]
+            : grid.elevation[from] - grid.elevation[to];
+        return d <= 1;
     }
 
-    bool contains(const Coords& node) const {
-        return find(steps.crbegin(), steps.crend(), node) != steps.crend();
+public:
+    ElevationSearch(const ElevationGrid& grid, Direction direction)
+        : grid(grid)
+        , direction(direction)
+        , distances(grid.size(), unreached)
+        , parents(grid.size(), ElevationGrid::noIndex)
+    {
+        frontier.reserve(grid.size());
     }
 
-    vector<Path> expand(ElevationGrid grid) const {
-        vector<Path> result;
-
-            for (const Direction& dir: { Direction::Up, Direction::Down, Direction::Left, Direction::Right }) {
-            if (grid.allowTransition(head(), dir)) {
-
-                const auto newHead = head() + to_Coords(dir);
-                if (!contains(newHead)) {
-                    Path newPath = *this;
-                    newPath.steps.emplace_back(newHead);
+    // Searches from all the sources at once until a cell satisfies isGoal.
+    // Without a goal every reachable cell gets its distance.
+    template <typename TGoalChecker>
+    optional<Index> search(span<const Index> sources, TGoalChecker isGoal) {
+        ranges::fill(distances, unreached);
+        ranges::fill(parents, ElevationGrid::noIndex);
+        frontier.clear();
 
-                    result.emplace_back(forward<Path>(newPath));
-                }
+        for (const auto source : sources) {
+            if (distances[source] == unreached) {
+                distances[source] = 0;
+                frontier.push_back(source);
             }
         }
-        return result;
-    }
-
-    ostream& print(ostream& os, const ElevationGrid& grid, bool dead = false, const unordered_set<Coords>& closed = {}) const {
-        // copy target vectors
-        vector<vector<char>> result = grid.elevation;
-
-        // clear
-        for_each(result.begin(), result.end(), [](auto& row) {
-            for_each(row.begin(), row.end(), [](char& val) {
-                val = ' ';
-            });
-        });
-
-        auto put = [&result](const Coords& pos, char ch) {
-            result.at(pos.y).at(pos.x) = ch;
-        };
-
-        put(grid.goal, 'E');
 
-        for_each(begin(closed), end(closed), [&put](const auto& location) {
-            put(location, '.');
-        });
-
-        for (auto current = steps.cbegin(); current != steps.cend() - 1; ++current) {
-            const auto currentVal = *current;
-            auto next = current + 1;
-            const auto nextVal = *next;
-
-            const auto d = nextVal - currentVal;
-
-            const auto mapDirToChar = [](const Direction& dir) -> char {
-                switch (dir) {
-                case Direction::Up: return 'v';
-                case Direction::Down: return '^';
-                case Direction::Left: return '<';
-                case Direction::Right: return '>';
+        const auto width = grid.width;
+        // Every cell is queued at most once, so the vector never wraps
+        for (size_t head = 0; head < frontier.size(); ++head) {
+            const auto current = frontier[head];
+            if (isGoal(current)) {
+                return current;
+            }
 
-                default:
-                    return '*';
+            const auto x = current % width;
+            const auto visit = [&](Index next) {
+                if (distances[next] == unreached && allowTransition(current, next)) {
+                    distances[next] = distances[current] + 1;
+                    parents[next] = current;
+                    frontier.push_back(next);
                 }
             };
 
-            put(currentVal, mapDirToChar(to_Direction(nextVal - currentVal)));
+            if (current >= width) {
+                visit(static_cast<Index>(current - width));
+            }
+            if (current + width < grid.size()) {
+                visit(static_cast<Index>(current + width));
+            }
+            if (x > 0) {
+                visit(current - 1);
+            }
+            if (x + 1 < width) {
+                visit(current + 1);
+            }
         }
 
-        put(head(), dead ? 'X' : 'H');
-
-        //print
-        for_each(result.cbegin(), result.cend(), [](const auto& row) {
-            for_each(row.cbegin(), row.cend(), [](const char ch) {
-                cout << ch;
-            });
-        cout << '\n';
-        });
-
-        return os;
+        return nullopt;
     }
-};
-
-class PathHeuristic {
-public:
-    using value_type = size_t;
 
-    auto operator() (const Path& path) const {
-        return path.length();
+    uint32_t distance(Index cell) const {
+        return distances[cell];
     }
-};
-
-class PathGoalHeuristic {
-public:
-    const Coords goal;
-    using value_type = double;
 
-    PathGoalHeuristic(const Coords& goal)
-        :goal{ goal }
-    {
-
-    }
+    // The cells from a source to target, in search order
+    vector<Coords> path(Index target) const {
+        vector<Coords> result;
+        if (distances[target] == unreached) {
+            return result;
+        }
 
-    value_type operator()(const Path& path) const {
-        const auto length = static_cast<value_type>(path.length());
-        const auto remaining = static_cast<value_type>(manhattan(path.head(), goal));
+        for (auto cell = target; cell != ElevationGrid::noIndex; cell = parents[cell]) {
+            result.push_back(grid.coords(cell));
+        }
+        ranges::reverse(result);
 
-        return length + remaining;
+        return result;
     }
 };
 
-template <typename ValueType, typename KeyRetrieverType, typename HeuristicComputerType, typename HeuristicComparator = less<typename HeuristicComputerType::value_type>>
-class updatable_priority_queue {
-    struct NodeType {
-        HeuristicComputerType::value_type heuristicValue;
-        ValueType value;
+ostream& printPath(ostream& os, const ElevationGrid& grid, const vector<Coords>& path) {
+    vector<string> result(grid.height, string(grid.width, ' '));
+    const auto put = [&result](const Coords& pos, char ch) {
+        result.at(pos.y).at(pos.x) = ch;
     };
-    vector<NodeType> container;
-    const HeuristicComputerType heuristicComputer;
-    const HeuristicComparator heuristicComparator;
-    const KeyRetrieverType keyRetriever;
-
-public:
-    updatable_priority_queue(const KeyRetrieverType& keyRetriever = {}, const HeuristicComputerType& heuristicComputer = {}, const HeuristicComparator& heuristicComparator = {})
-        : container{}
-        , keyRetriever{ keyRetriever }
-        , heuristicComputer{ heuristicComputer }
-        , heuristicComparator{ heuristicComparator }
-    {
-    }
-
-    ValueType popBest() {
-        auto best = container.back();
-        container.pop_back();
 
-        return best.value;
-    }
+    put(grid.coords(grid.goal), 'E');
 
-    void insert(ValueType&& toInsert) {
-        const auto newKey = keyRetriever(toInsert);
-        const auto newHeuristicValue = heuristicComputer(toInsert);
-
-        // find current element
-        auto it = find_if(begin(container), end(container), [&newKey, &capturedKeyRetriever = keyRetriever](const auto& current) {
-            return capturedKeyRetriever(current.value) == newKey;
-            });
-
-        if (it != container.end()) {
-            // found the elemenet with the same key
-            if (!heuristicComparator(newHeuristicValue, it->heuristicValue)) {
-                // new value doesnt have smaller heuristic than the existing one
-                // Keep the existing value and ignore the new one
-                return;
-            }
-            else {
-                // new value has smaller heuristic than the existing one. Remove the
-                // the existing and proceed to add the new to the appropriate place
-                auto new_last = container.erase(it);
-            }
-        }
-
-        // add new value
-        NodeType newNode{ newHeuristicValue, forward<ValueType>(toInsert) };
-        auto addLocation = upper_bound(begin(container), end(container), newNode, [&capturedHeuristicComparator = heuristicComparator](const NodeType& lhs, const NodeType& rhs) {
-            return !capturedHeuristicComparator(lhs.heuristicValue, rhs.heuristicValue);
-            });
-
-        container.insert(addLocation, forward<NodeType>(newNode));
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        const auto d = path[i + 1] - path[i];
+        put(path[i], d == Up ? 'v' : d == Down ? '^' : d == Left ? '<' : '>');
     }
-
-    auto empty() const {
-        return container.empty();
+    if (!path.empty()) {
+        put(path.back(), 'H');
     }
-};
-
-template <typename TGoalHeuristic, typename TGoalChecker>
-class PathResolver {
-    const ElevationGrid& grid;
-
-    TGoalHeuristic heuristic;
-    TGoalChecker goalChecker;
-    updatable_priority_queue<Path, function<Coords(Path)>, TGoalHeuristic> open;
-    unordered_set<Coords> closed;
 
-public:
-    PathResolver(const decltype(ElevationGrid::start) start, const ElevationGrid& grid, const TGoalHeuristic& heuristic, const TGoalChecker& goalChecker)
-        : grid(grid)
-        , heuristic{ heuristic }
-        , goalChecker{ goalChecker }
-        , open{ mem_fn(&Path::head), heuristic }
-    {
-        open.insert(start);
+    for (const auto& row : result) {
+        os << row << '\n';
     }
 
-    optional<Path> findPath() {
-        
-        while (!open.empty()) {
-            const auto current = open.popBest();
-
-            if (goalChecker(current.head())) {
-                return optional(current);
-            }
-            else {
-                closed.emplace(current.head());
-            }
-
-            auto expanded = current.expand(grid);
-            for (auto& next : expanded) {
-                if (!closed.contains(next.head())) {
-                    open.insert(forward<Path>(next));
-                }
-            }
-        }
-
-        return nullopt;
-    }
-};
+    return os;
+}
 
 ostream& operator<<(ostream& os, const ElevationGrid& grid) {
-    for (const auto& row : grid.elevation) {
-        for (const auto& element : row) {
-            os << element;
-        }
-        os << endl;
+    for (size_t y = 0; y < grid.height; ++y) {
+        os << string_view(grid.elevation.data() + y * grid.width, grid.width) << endl;
     }
 
     return os;
 }
 
 DayResult day12() {
-    const auto input = readFile("day_12_input.txt");
-    ElevationGrid grid(input);
+    PartTimer timer;
+    const LineView input("day_12_input.txt");
+    const ElevationGrid grid(input);
     //cout << grid << endl;
 
-
-    PathResolver resolver{
-        grid.start,
-        grid,
-        PathGoalHeuristic{grid.goal},
-        [goal = grid.goal](const Coords& toCheck) {
-            return toCheck == goal;
-    } };
-
-    const optional<Path> result1 = resolver.findPath();
-    const auto steps = result1.transform(mem_fn(&Path::length)).value_or(0);
-
-
-
-    grid.forwardSearch = false;
-    PathResolver resolver2{
-        grid.goal,
-        grid,
-        PathHeuristic{},
-        [&grid](const Coords& current) {
-            return grid.at(current) == 'a';
-    } };
-    const auto result2 = resolver2.findPath();
-    const auto steps2 = result2.transform(mem_fn(&Path::length)).value_or(0);
-
-
-    //if (result2.has_value()) {
-    //    const auto path = result2.value();
-    //    cout << "Steps: " << path.length() << endl;
-    //    path.print(cout, grid);
+    ElevationSearch forward(grid, ElevationSearch::Direction::Forward);
+    const ElevationGrid::Index start[] = { grid.start };
+    const auto found1 = forward.search(start, [goal = grid.goal](ElevationGrid::Index cell) {
+        return cell == goal;
+    });
+    const auto steps = found1.transform([&forward](auto cell) { return forward.distance(cell); }).value_or(0);
+    const auto part1Time = timer.lap();
+
+    // From the goal down to the nearest 'a' instead of from every 'a'
+    ElevationSearch reverse(grid, ElevationSearch::Direction::Reverse);
+    const ElevationGrid::Index goal[] = { grid.goal };
+    const auto found2 = reverse.search(goal, [&grid](ElevationGrid::Index cell) {
+        return grid.elevation[cell] == 'a';
+    });
+    const auto steps2 = found2.transform([&reverse](auto cell) { return reverse.distance(cell); }).value_or(0);
+    const auto part2Time = timer.lap();
+
+    //if (found1.has_value()) {
+    //    printPath(cout, grid, forward.path(*found1));
     //}
 
     return {
-        make_optional<PartialDayResult>({"Steps", to_string(steps)}),
-        make_optional<PartialDayResult>({"Steps", to_string(steps2)})
+        make_optional<PartialDayResult>({"Steps", to_string(steps), part1Time}),
+        make_optional<PartialDayResult>({"Steps", to_string(steps2), part2Time})
     };
 }
@@ -2,6 +2,7 @@
 #include "utils.h"
 
 #include <string>
+#include <string_view>
 
 #include <map>
 #include <numeric>
@@ -96,7 +97,7 @@ class Day2Play {
     }
 
 public:
-    Day2Play(const string& playDef) {
+    Day2Play(const string_view playDef) {
         if (playDef.size() != 3 || playDef[1] != ' ') {
             throw std::exception("Not a valid play");
         }
@@ -121,9 +122,10 @@ public:
 };
 
 DayResult day2() {
-    const auto lines = readFile("day_2_input.txt");
+    PartTimer timer;
+    const LineView lines("day_2_input.txt");
 
-    const int forwardResult = accumulate(lines.begin(), lines.end(), 0, [](int&& currentScore, const string& line) {
+    const int forwardResult = accumulate(lines.begin(), lines.end(), 0, [](int&& currentScore, const string_view line) {
         Day2Play play(line);
     play.fixOutcome();
     const int lineScore = play.score();
@@ -132,8 +134,9 @@ DayResult day2() {
         });
 
     // cout << "Forward accumulated score: " << forwardResult << endl;
+    const auto part1Time = timer.lap();
 
-    const int reverseResult = accumulate(lines.begin(), lines.end(), 0, [](int&& currentScore, const string& line) {
+    const int reverseResult = accumulate(lines.begin(), lines.end(), 0, [](int&& currentScore, const string_view line) {
         Day2Play play(line);
     play.fixMyPLay();
     const int lineScore = play.score();
@@ -142,9 +145,10 @@ DayResult day2() {
         }
     );
     // cout << "Reverse accumulated score: " << reverseResult << endl;
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Forward accumulated score", to_string(forwardResult)}),
-        make_optional<PartialDayResult>({"Reverse accumulated score", to_string(reverseResult)})
+        make_optional<PartialDayResult>({"Forward accumulated score", to_string(forwardResult), part1Time}),
+        make_optional<PartialDayResult>({"Reverse accumulated score", to_string(reverseResult), part2Time})
     };
 }
@@ -1,105 +1,132 @@
 #include "day.h"
 #include "utils.h"
 
+#include "ParsingError.h"
+
 #include <string>
-#include <span>
+#include <string_view>
 #include <stdexcept>
 #include <algorithm>
 #include <vector>
-#include <numeric>
-#include <iterator>
+#include <thread>
+#include <bit>
+#include <cstdint>
+#include <exception>
 
 using namespace std;
 
-class Rucksack {
-    string contents;
+using ItemSet = uint64_t;
+
+// Bit p for an item of priority p: a-z are 1-26, A-Z are 27-52
+ItemSet itemSet(const string_view items) {
+    ItemSet result = 0;
+    bool letters = true;
+    for (const unsigned char ch : items) {
+        // lower case letters have the 0x20 bit, both cases share the low 5 bits
+        const unsigned upper = ((ch >> 5) & 1) ^ 1;
+        result |= ItemSet{ 1 } << ((ch & 31) + 26 * upper);
+        letters &= static_cast<unsigned char>((ch | 0x20) - 'a') < 26;
+    }
 
-public:
-    Rucksack(const string input) :contents(input) {
+    if (!letters) {
+        throw ParsingError("Bad item in [" + string(items) + "]");
+    }
+    return result;
+}
 
+// Priority of the one item in the set
+int onlyItemPriority(const ItemSet items) {
+    if (!has_single_bit(items)) {
+        throw runtime_error("No single common item was found");
     }
+    return countr_zero(items);
+}
 
-    char findCommonInCompartments() {
-        auto begin = contents.begin();
-        auto end = contents.end();
-        auto mid = begin + std::distance(begin, end) / 2;
+class Rucksack {
+    ItemSet compartment1;
+    ItemSet compartment2;
 
-        span<char> compartment1(begin, mid);
-        span<char> compartment2(mid, end);
+public:
+    Rucksack(const string_view input)
+        : compartment1(itemSet(input.substr(0, input.size() / 2)))
+        , compartment2(itemSet(input.substr(input.size() / 2)))
+    {
+    }
 
-        std::sort(compartment1.begin(), compartment1.end());
-        std::sort(compartment2.begin(), compartment2.end());
+    int commonInCompartmentsPriority() const {
+        return onlyItemPriority(compartment1 & compartment2);
+    }
+};
 
-        auto i1 = compartment1.begin();
-        auto i2 = compartment2.begin();
+int badgePriority(const string_view sack1, const string_view sack2, const string_view sack3) {
+    return onlyItemPriority(itemSet(sack1) & itemSet(sack2) & itemSet(sack3));
+}
 
-        while (i1 != compartment1.end() && i2 != compartment2.end()) {
-            if (*i1 == *i2) {
-                return *i1;
-            }
-            if (*i1 < *i2) {
-                ++i1;
+// Minimum of rucksacks per thread, less isn't worth starting one
+constexpr size_t minSacksPerThread = 1 << 16;
+
+// Sum of value(i) for i in [0, count), split in contiguous ranges among the threads
+template <typename TValue>
+long long parallelSum(const size_t count, TValue value, unsigned threads = dayThreads()) {
+    threads = static_cast<unsigned>(clamp<size_t>(threads, 1, max<size_t>(1, count / minSacksPerThread)));
+
+    vector<long long> sums(threads, 0);
+    // An exception leaving a thread would terminate, so each worker keeps its
+    // own and the first one is rethrown once they are all joined
+    vector<exception_ptr> errors(threads);
+    {
+        const auto worker = [&](unsigned t) {
+            try {
+                long long sum = 0;
+                for (size_t i = count * t / threads; i < count * (t + 1) / threads; ++i) {
+                    sum += value(i);
+                }
+                sums[t] = sum;
             }
-            else {
-                ++i2;
+            catch (...) {
+                errors[t] = current_exception();
             }
+        };
+
+        vector<jthread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker, t);
         }
-        throw runtime_error("No common item was found");
+        worker(0);
     }
 
-
-};
-
-int itemPriority(const char ch) {
-    if ('a' <= ch && ch <= 'z') {
-        return ch - 'a' + 1;
-    }
-    else {
-        return ch - 'A' + 27;
+    for (const auto& error : errors) {
+        if (error) {
+            rethrow_exception(error);
+        }
     }
-}
 
-char findCommon(string str1, string str2, string str3) {
-    ranges::sort(str1);
-    ranges::sort(str2);
-    ranges::sort(str3);
-
-    const auto [first1, last1] = ranges::unique(str1);
-    const auto [first2, last2] = ranges::unique(str2);
-    const auto [first3, last3] = ranges::unique(str3);
-
-    vector<char> intermediate;
-    set_intersection(str1.begin(), first1, str2.begin(), first2, back_inserter(intermediate));
-
-    vector<char> result;
-    set_intersection(intermediate.cbegin(), intermediate.cend(), str3.begin(), first3, back_inserter(result));
-
-    if (result.size() != 1) {
-        throw runtime_error("Bad result");
+    long long result = 0;
+    for (const auto sum : sums) {
+        result += sum;
     }
-    return result[0];
+    return result;
 }
 
 DayResult day3() {
-    const auto lines = readFile("day_3_input.txt");
+    PartTimer timer;
+    const LineView lines("day_3_input.txt");
 
-    const auto prioritySum = accumulate(lines.begin(), lines.end(), 0, [](int currentSum, const auto line) {
-        Rucksack sack(line);
-    return currentSum + itemPriority(sack.findCommonInCompartments());
-        }
-    );
-
-    int badgePrioritySum = 0;
-    auto iter = lines.begin();
-    while (iter != lines.end()) {
-        const auto badge = findCommon(*iter, *(iter + 1), *(iter + 2));
-        const auto priority = itemPriority(badge);
-        badgePrioritySum += priority;
-        iter += 3;
+    const auto prioritySum = parallelSum(lines.size(), [&lines](size_t i) {
+        return Rucksack(lines[i]).commonInCompartmentsPriority();
+    });
+    const auto part1Time = timer.lap();
+
+    if (lines.size() % 3 != 0) {
+        throw ParsingError("The rucksacks don't split in groups of three");
     }
+    const auto badgePrioritySum = parallelSum(lines.size() / 3, [&lines](size_t group) {
+        return badgePriority(lines[3 * group], lines[3 * group + 1], lines[3 * group + 2]);
+    });
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Priority sum", to_string(prioritySum)}),
-        make_optional<PartialDayResult>({"Badge priority sum", to_string(badgePrioritySum)})
+        make_optional<PartialDayResult>({"Priority sum", to_string(prioritySum), part1Time}),
+        make_optional<PartialDayResult>({"Badge priority sum", to_string(badgePrioritySum), part2Time})
     };
 }
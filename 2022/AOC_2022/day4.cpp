@@ -9,28 +9,26 @@
 
 using namespace std;
 
-Range parseRange(const string_view& input) {
-    const auto dashLocation = input.begin() + input.find('-');
+Range parseRange(const string_view input) {
+    const auto dashLocation = input.find('-');
 
     int begin = 0;
-    string beginStr{ input.begin(), dashLocation };
-    if (const auto [ptr, ec] = from_chars(beginStr.data(), beginStr.data() + beginStr.length(), begin); ec != std::errc()) {
+    if (const auto [ptr, ec] = from_chars(input.data(), input.data() + dashLocation, begin); ec != std::errc()) {
         throw runtime_error("Failed to parse the begin number");
     }
 
     int end = 0;
-    const string strEnd{ dashLocation + 1, input.end() };
-    if (const auto [ptr, ec] = from_chars(strEnd.data(), strEnd.data() + strEnd.length(), end); ec != std::errc()) {
+    if (const auto [ptr, ec] = from_chars(input.data() + dashLocation + 1, input.data() + input.size(), end); ec != std::errc()) {
         throw runtime_error("Failed to parse the end number");
     }
 
     return Range{ begin, end };
 }
 
-tuple<Range, Range> parseRangesPair(const string line) {
-    const auto commaLocation = line.cbegin() + line.find(',');
-    string_view range1Str(line.cbegin(), commaLocation);
-    string_view range2Str(commaLocation + 1, line.cend());
+tuple<Range, Range> parseRangesPair(const string_view line) {
+    const auto commaLocation = line.find(',');
+    const auto range1Str = line.substr(0, commaLocation);
+    const auto range2Str = line.substr(commaLocation + 1);
 
     auto range1 = parseRange(range1Str);
     auto range2 = parseRange(range2Str);
@@ -39,7 +37,8 @@ tuple<Range, Range> parseRangesPair(const string line) {
 }
 
 DayResult day4() {
-    const auto lines = readFile("day_4_input.txt");
+    PartTimer timer;
+    const LineView lines("day_4_input.txt");
 
     int fullyContainedSum = 0;
     int overlapsSum = 0;
@@ -55,9 +54,11 @@ DayResult day4() {
             ++overlapsSum;
         }
     }
+    // Both parts are counted in the same pass
+    const auto part1Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Fully contined ranges count", to_string(fullyContainedSum)}),
-        make_optional<PartialDayResult>({"Overlapping ranges", to_string(overlapsSum)})
+        make_optional<PartialDayResult>({"Fully contined ranges count", to_string(fullyContainedSum), part1Time}),
+        make_optional<PartialDayResult>({"Overlapping ranges", to_string(overlapsSum), timer.lap()})
     };
 }
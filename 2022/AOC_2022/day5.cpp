@@ -2,140 +2,140 @@
 #include "utils.h"
 #include "printers.h"
 
-#include "TaggedStack.h"
+#include "CrateStacks.h"
 #include "StackCommand.h"
 #include "ParsingError.h"
 
-#include <sstream>
+#include <string_view>
+#include <charconv>
 #include <ranges>
 #include <algorithm>
-#include <iterator>
+#include <numeric>
 
 using namespace std;
 
-vector<TaggedStack> parseStacks(const auto& strLabels, const auto& lines) {
-
-    // create the stacks based on the labels line
-    istringstream iss(strLabels);
-    auto v = ranges::subrange{ istream_iterator<string>(iss), istream_iterator<string>() }
-        | views::transform([](const auto& value) {
-        return TaggedStack(value);
-            });
-
-    vector<TaggedStack> stacks;
-    ranges::copy(v, back_inserter(stacks));
+// The drawing above the labels line, as the tags and the crates of each stack
+struct StacksDrawing {
+    vector<size_t> tags;
+    vector<string> contents;
+};
+
+StacksDrawing parseStacks(const string_view labelsLine, const auto& lines) {
+    StacksDrawing result;
+
+    // the crate letters are in the columns of the labels
+    vector<size_t> columns;
+    for (size_t pos = labelsLine.find_first_not_of(' '); pos != string_view::npos; pos = labelsLine.find_first_not_of(' ', pos)) {
+        size_t tag = 0;
+        const auto [ptr, ec] = from_chars(labelsLine.data() + pos, labelsLine.data() + labelsLine.size(), tag);
+        if (ec != errc()) {
+            throw ParsingError("Bad stack label: " + string(labelsLine));
+        }
+        result.tags.push_back(tag);
+        columns.push_back(pos);
+        pos = ptr - labelsLine.data();
+    }
+    result.contents.resize(columns.size());
 
     // fill the stacks
     for (const auto line : views::reverse(lines)) {
-        for (int stackIndex = 0; 4 * stackIndex + 2 < line.length(); ++stackIndex) {
-            const int i = 4 * stackIndex;
-
-            if (line[i] == '[' && line[i + 2] == ']') {
-                stacks[stackIndex].stack.push(line[i + 1]);
+        for (size_t stackIndex = 0; stackIndex < columns.size(); ++stackIndex) {
+            const auto column = columns[stackIndex];
+            if (column > 0 && column + 1 < line.length() && line[column - 1] == '[' && line[column + 1] == ']') {
+                result.contents[stackIndex].push_back(line[column]);
             }
         }
     }
 
-    return stacks;
+    return result;
 }
 
+// "move <amount> from <tag> to <tag>", with the tags resolved to stack indices
+template <typename TStacks>
+StackCommand parseStackCommand(const string_view input, const TStacks& stacks) {
+    string_view rest = input;
+    const auto expect = [&rest, input](string_view word) {
+        if (!rest.starts_with(word)) {
+            throw ParsingError("\"" + string(word) + "\" not detected in: " + string(input));
+        }
+        rest.remove_prefix(word.size());
+    };
+    const auto number = [&rest, input]() {
+        size_t value = 0;
+        const auto [ptr, ec] = from_chars(rest.data(), rest.data() + rest.size(), value);
+        if (ec != errc()) {
+            throw ParsingError("Number not detected in: " + string(input));
+        }
+        rest.remove_prefix(ptr - rest.data());
+        return value;
+    };
 
-StackCommand parseStackCommand(const string& input) {
-    istringstream iss(input);
-    int amount;
-    string from, to;
+    expect("move ");
+    const auto amount = number();
+    expect(" from ");
+    const auto from = number();
+    expect(" to ");
+    const auto to = number();
 
-    string dummy;
-    iss >> dummy;
-    if (dummy != "move") {
-        throw ParsingError("\"move\" not detected");
-    }
-    iss >> amount;
+    return { stacks.index(from), stacks.index(to), amount };
+}
 
-    iss >> dummy;
-    if (dummy != "from") {
-        throw ParsingError("\"from\" not detected");
-    }
-    iss >> from;
+template <typename TStack>
+string runCommands(const StacksDrawing& drawing, const auto& commandsDef, bool keepOrder) {
+    CrateStacks<TStack> stacks(drawing.tags, drawing.contents);
 
-    iss >> dummy;
-    if (dummy != "to") {
-        throw ParsingError("\"frtoom\" not detected");
+    for (const auto line : commandsDef) {
+        stacks.execute(parseStackCommand(line, stacks), keepOrder);
     }
-    iss >> to;
 
-    return { from, to, amount };
+    //std::cout << "Stacks: " << stacks.all() << endl;
+    return stacks.message();
 }
 
-string getStacksMessage(const vector<TaggedStack>& stacks) {
-    stringstream ss;
-    ranges::for_each(stacks, [&ss](const auto& st) {
-        const auto value = st.stack.top();
-    ss << value;
-        });
-    return ss.str();
-}
+// Above this many crates per command the crates are moved as chunks
+constexpr size_t chunkedAverageAmount = 256;
 
 DayResult day5() {
-    const auto lines = readFile("day_5_input.txt");
+    PartTimer timer;
+    const LineView lines("day_5_input.txt");
 
     // find empty lines (stacks-commands separator)
-    const auto emptyLine = std::find_if(lines.begin(), lines.end(), [](const auto& str) {return str.empty(); });
+    const auto emptyLine = ranges::find_if(lines, [](const auto str) { return str.empty(); });
+    if (emptyLine == lines.begin() || emptyLine == lines.end()) {
+        throw ParsingError("No separator between the stacks and the commands");
+    }
 
-    const auto& labelsLine = *(emptyLine - 1);
+    const auto labelsLine = *(emptyLine - 1);
     const auto stacksDef = ranges::subrange(lines.begin(), emptyLine - 1);
     const auto commandsDef = ranges::subrange(emptyLine + 1, lines.end());
 
-    /* part 1 */
-    auto stacksProcessor = [labelsLine, stacksDef, commandsDef](auto commandProcessor)
-    {
-        auto stacks = parseStacks(labelsLine, stacksDef);
+    const auto drawing = parseStacks(labelsLine, stacksDef);
 
-
-        for (const auto& line : commandsDef) {
-            const auto cmd = parseStackCommand(line);
-
-            const auto findSourceByTag = [&cmd](const auto& st) { return st.tag == cmd.source; };
-            const auto findTargetByTag = [&cmd](const auto& st) { return st.tag == cmd.target; };
-
-            auto& source = ranges::find_if(stacks, findSourceByTag)->stack;
-            auto& destination = ranges::find_if(stacks, findTargetByTag)->stack;
-
-
-            if (source.size() < cmd.amount) {
-                throw runtime_error("Not enough in the source while executing command");
-                continue;
-            }
-            commandProcessor(source, destination, cmd.amount);
+    // The amounts are peeked at to pick between the stack kinds
+    const auto totalAmount = accumulate(commandsDef.begin(), commandsDef.end(), size_t{ 0 }, [](size_t sum, const auto line) {
+        size_t amount = 0;
+        if (line.size() > 5) {
+            from_chars(line.data() + 5, line.data() + line.size(), amount);
         }
+        return sum + amount;
+    });
+    const bool chunked = totalAmount > chunkedAverageAmount * static_cast<size_t>(commandsDef.size());
 
-        //std::cout << "Crates message: " << getStacksMessage(stacks) << endl;
-        return getStacksMessage(stacks);
+    const auto run = [&](bool keepOrder) {
+        return chunked
+            ? runCommands<ChunkedCrateStack>(drawing, commandsDef, keepOrder)
+            : runCommands<CrateStack>(drawing, commandsDef, keepOrder);
     };
 
-    string msg1 = stacksProcessor([](auto& src, auto& dst, int amount) {
-        for (int i = 0; i < amount; ++i) {
-            const char value = src.top();
-            dst.push(value);
-            src.pop();
-        }
-        });
+    /* part 1 */
+    const auto msg1 = run(false);
+    const auto part1Time = timer.lap();
 
-
-    string msg2 = stacksProcessor([](auto& src, auto& dst, int amount) {
-        stack<char> tmp;
-        for (int i = 0; i < amount; ++i) {
-            tmp.push(src.top());
-            src.pop();
-        }
-        for (int i = 0; i < amount; ++i) {
-            dst.push(tmp.top());
-            tmp.pop();
-        }
-    });
+    const auto msg2 = run(true);
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Crates message", msg1}),
-        make_optional<PartialDayResult>({"Crates message", msg2})
+        make_optional<PartialDayResult>({"Crates message", msg1, part1Time}),
+        make_optional<PartialDayResult>({"Crates message", msg2, part2Time})
     };
-}
\ No newline at end of file
+}
@@ -1,39 +1,105 @@
 #include "day.h"
+#include "utils.h"
 
 #include "ParsingError.h"
 
 #include <cassert>
-#include <fstream>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
-size_t find_unique(const string& input, const size_t window) {
-    // check if window is ok. if not, push it after the last matching pair
-
-    for (size_t w = window - 1; w < input.size(); ) {
-        for (size_t x = 0; x < window - 1; ++x) {
-            const char wChar = input[w - x];
-            for (size_t y = x + 1; y < window; ++y) {
-                const char xChar = input[w - y];
-                if (wChar == xChar) {
-                    // collision character was found. Bump the window accordingly to exclude the 'y' character
-                    w += window - y;
-                    goto check_next_window;
+// Ends of windows scanned by one thread at a time
+constexpr size_t bytesPerChunk = 1 << 22;
+
+// Position after the first window of distinct bytes whose last byte is in
+// [first, last), npos if there is none. The window keeps a count per byte
+// value and how many values repeat in it, so each byte costs O(1) whatever
+// the window size.
+size_t scanWindows(const string_view input, const size_t window, const size_t first, const size_t last) {
+    array<size_t, 256> counts{};
+    size_t repeated = 0;
+
+    const auto add = [&](unsigned char ch) {
+        if (++counts[ch] == 2) {
+            ++repeated;
+        }
+    };
+    const auto remove = [&](unsigned char ch) {
+        if (--counts[ch] == 1) {
+            --repeated;
+        }
+    };
+
+    for (size_t i = first + 1 - window; i < first; ++i) {
+        add(input[i]);
+    }
+
+    for (size_t end = first; end < last; ++end) {
+        add(input[end]);
+        if (repeated == 0) {
+            return end + 1;
+        }
+        remove(input[end + 1 - window]);
+    }
+
+    return string_view::npos;
+}
+
+// Big inputs are split in chunks of window ends, each scanned with the window
+// - 1 bytes before it. The threads take the chunks in order, so once a marker
+// is found only the chunks before it still have to finish.
+size_t find_unique(const string_view input, const size_t window, unsigned threads = dayThreads()) {
+    if (window == 0) {
+        throw invalid_argument("Empty window");
+    }
+    if (input.size() < window) {
+        throw ParsingError("Exceeded input");
+    }
+
+    const size_t firstEnd = window - 1;
+    const size_t chunks = (input.size() - firstEnd + bytesPerChunk - 1) / bytesPerChunk;
+    threads = static_cast<unsigned>(clamp<size_t>(threads, 1, chunks));
+
+    atomic<size_t> next{ 0 };
+    atomic<size_t> found{ string_view::npos };
+    {
+        const auto worker = [&]() {
+            for (size_t chunk; (chunk = next++) < chunks;) {
+                const size_t begin = firstEnd + chunk * bytesPerChunk;
+                if (begin >= found) {
+                    return;
+                }
+
+                const auto marker = scanWindows(input, window, begin, min(begin + bytesPerChunk, input.size()));
+                if (marker != string_view::npos) {
+                    for (size_t current = found; marker < current && !found.compare_exchange_weak(current, marker);) {
+                    }
+                    return;
                 }
             }
-        }
-        // no collision was found
-        return w + 1;
+        };
 
-    check_next_window:
-        ;
+        vector<jthread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+    }
 
+    if (found == string_view::npos) {
+        throw ParsingError("Exceeded input");
     }
-    throw ParsingError("Exceeded input");
+    return found;
 }
 
 
-size_t startOfPacket(const string& input) {
+size_t startOfPacket(const string_view input) {
     if (input.size() < 4) {
         throw runtime_error("Not enough symbolds to detect the start_of_packet");
     }
@@ -41,7 +107,7 @@ size_t startOfPacket(const string& input) {
     return find_unique(input, 4);
 }
 
-size_t startOfMessage(const string& input) {
+size_t startOfMessage(const string_view input) {
     if (input.size() < 14) {
         throw runtime_error("Not enough symbolds to detect the start_of_message");
     }
@@ -54,10 +120,15 @@ DayResult day6() {
     assert(startOfPacket("nznrnfrfntjfmvfwmzdfjlvtqnbhcprsg") == 10);
     assert(startOfPacket("zcfzfwzzqfrljwzlrfnpqdbhtmscgvjw") == 11);
 
-    ifstream infile("day_6_input.txt");
-    std::string input{ istream_iterator<char>(infile), istream_iterator<char>() };
+    PartTimer timer;
+    const LineView lines("day_6_input.txt");
+    if (lines.empty()) {
+        throw ParsingError("Empty input");
+    }
+    const auto input = lines[0];
 
     const auto packetStart = startOfPacket(input);
+    const auto part1Time = timer.lap();
 
     assert(startOfMessage("mjqjpqmgbljsphdztnvjfqwrcgsmlb") == 19);
     assert(startOfMessage("bvwbjplbgvbhsrlpgdmjqwftvncz") == 23);
@@ -66,9 +137,10 @@ DayResult day6() {
     assert(startOfMessage("zcfzfwzzqfrljwzlrfnpqdbhtmscgvjw") == 26);
 
     const auto messageStart = startOfMessage(input);
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Start of packet", to_string(packetStart)}),
-        make_optional<PartialDayResult>({"Start of message", to_string(messageStart)})
+        make_optional<PartialDayResult>({"Start of packet", to_string(packetStart), part1Time}),
+        make_optional<PartialDayResult>({"Start of message", to_string(messageStart), part2Time})
     };
 }
@@ -5,85 +5,137 @@
 #include "Filesystem.h"
 #include "FilesystemPrinter.h"
 
-#include "DirectorySizeComputer.h"
-#include "FilteredDirSizeReporter.h"
 #include "DeleteDirectorySelector.h"
 
-#include <sstream>
+#include <fstream>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
 
 using namespace std;
 
-Filesystem parseConsoleInput(const vector<string>& input) {
-    Filesystem fs;
+// Feeds the lines of a shell transcript to the filesystem as they come
+class ConsoleLogParser {
+    Filesystem& fs;
+    // Lines after an ls are its output
+    bool listing = false;
 
-    for (auto line = input.begin(); line != input.end(); ++line) {
-        istringstream iss(*line);
-        string token;
-        iss >> token;
-        if (token != "$") {
-            throw ParsingError("Not a command");
-        }
+    static bool startsWith(string_view str, string_view prefix) {
+        return str.substr(0, prefix.size()) == prefix;
+    }
 
-        iss >> token;
-        if (token == "cd") {
-            string dirToken;
-            iss >> dirToken;
-            fs.cd(dirToken);
+public:
+    ConsoleLogParser(Filesystem& fs)
+        :fs(fs)
+    {
+    }
+
+    void parseLine(string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            return;
         }
-        if (token == "ls") {
-            // parse response lines until a command lins is found
-            while ((line + 1) != input.end() && (line + 1)->at(0) != '$') {
-                ++line;
-
-                // parse ls response line
-                string lsToken1, lsToken2;
-                istringstream iss2(*line);
-                iss2 >> lsToken1 >> lsToken2;
-                if (lsToken1 == "dir") {
-                    fs.addDir(lsToken2);
-                }
-                else {
-                    const size_t size = atoi(lsToken1.data());
-                    fs.addFile(lsToken2, size);
-                }
+
+        if (startsWith(line, "$ ")) {
+            const auto command = line.substr(2);
+            listing = command == "ls";
+            if (startsWith(command, "cd ")) {
+                fs.cd(command.substr(3));
             }
+            else if (!listing) {
+                throw ParsingError("Unknown command: " + string(command));
+            }
+            return;
+        }
+
+        if (!listing) {
+            throw ParsingError("Not a command: " + string(line));
         }
 
+        if (startsWith(line, "dir ")) {
+            fs.addDir(line.substr(4));
+            return;
+        }
 
+        size_t size = 0;
+        const auto [ptr, ec] = from_chars(line.data(), line.data() + line.size(), size);
+        if (ec != errc() || ptr == line.data() + line.size() || *ptr != ' ') {
+            throw ParsingError("Bad ls output: " + string(line));
+        }
+        fs.addFile(line.substr(ptr - line.data() + 1), size);
     }
+};
 
+// Reads the transcript in chunks, only the unfinished last line of a chunk is kept
+Filesystem parseConsoleInput(istream& input) {
+    Filesystem fs;
+    ConsoleLogParser parser(fs);
+
+    vector<char> buffer(1 << 16);
+    size_t carried = 0;
+    while (input) {
+        {
+            const ReadTimer readTimer;
+            input.read(buffer.data() + carried, buffer.size() - carried);
+        }
+        const auto readCount = static_cast<size_t>(input.gcount());
+        if (readCount == 0) {
+            break;
+        }
+
+        const char* begin = buffer.data();
+        const char* const end = begin + carried + readCount;
+        for (const void* newline; (newline = memchr(begin, '\n', end - begin)) != nullptr;) {
+            const auto lineEnd = static_cast<const char*>(newline);
+            parser.parseLine({ begin, lineEnd });
+            begin = lineEnd + 1;
+        }
+
+        carried = end - begin;
+        memmove(buffer.data(), begin, carried);
+        // a line longer than the buffer
+        if (carried == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+
+    parser.parseLine({ buffer.data(), carried });
 
     return fs;
 }
 
-
 DayResult day7() {
-    const auto consoleLog = readFile("day_7_input.txt");
+    PartTimer timer;
+    ifstream consoleLog = [] {
+        const ReadTimer readTimer;
+        return ifstream("day_7_input.txt", ios::binary);
+    }();
+    if (!consoleLog) {
+        throw runtime_error("Couldn't open day_7_input.txt");
+    }
     auto fs = parseConsoleInput(consoleLog);
 
-    fs.cd("/");
+    fs.computeSizes();
 
     //FilesystemPrinter printer;
-    //fs.accept(printer);
-
-    FilteredDirSizeReporter reporter;
-    DirectorySizeComputer visitor(reporter);
-
-    fs.accept(visitor);
+    //printer.print(fs);
 
-    DeleteDirectorySelector selector(visitor.dirSize);
-    DirectorySizeComputer visitor2(selector);
+    const auto filteredSize = fs.directorySizeSum(100000);
+    const auto part1Time = timer.lap();
 
-    fs.accept(visitor2);
+    DeleteDirectorySelector selector(fs);
 
     if (!selector.selected.has_value()) {
         throw runtime_error("No dir was selected for deletion");
     }
+    const auto part2Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Reported (filtered) accumulated size", to_string(reporter.accumulatedSize)}),
-        make_optional<PartialDayResult>({"Size of dir (" + selector.selected->name + ") selected for deletion", to_string(selector.selected->size)})
+        make_optional<PartialDayResult>({"Reported (filtered) accumulated size", to_string(filteredSize), part1Time}),
+        make_optional<PartialDayResult>({"Size of dir (" + selector.selected->name + ") selected for deletion", to_string(selector.selected->size), part2Time})
     };
 }
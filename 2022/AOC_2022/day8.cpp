@@ -5,32 +5,38 @@
 
 #include "printers.h"
 
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
 using namespace std;
 
 DayResult day8() {
-    const auto input = readFile("day_8_input.txt");
-
-    const size_t n = std::max(input[0].length(), input.size());
-    const auto inputLocationMapper = [&input](const SizePoint& p) -> Grid::Location {
-        return input[p.y][p.x] - '0';
-    };
+    PartTimer timer;
+    const LineView input("day_8_input.txt");
+
+    const size_t width = input.empty() ? 0 : input[0].length();
+    vector<Grid::Height> heights;
+    heights.reserve(width * input.size());
+    for (const auto line : input) {
+        if (line.length() != width) {
+            throw runtime_error("The rows of the grid have different lengths");
+        }
+        ranges::transform(line, back_inserter(heights), [](char ch) { return static_cast<Grid::Height>(ch - '0'); });
+    }
 
-    Grid grid(n, inputLocationMapper);
+    Grid grid(width, input.size(), move(heights));
     grid.computeVisibility();
     // cout << "Grid:\n" << grid << endl;
 
-    size_t visibleCount = 0;
-    long maxScenicScore = 0;
-
-    grid.visitTopDownLeftRight([&visibleCount, &maxScenicScore](auto, const Grid::Location& current) {
-        if (current.isVisible) {
-            ++visibleCount;
-        }
-        maxScenicScore = std::max(maxScenicScore, current.scenicScore);
-    });
+    const auto visibleCount = grid.visibleCount();
+    const auto maxScenicScore = grid.maxScenicScore();
+    // Both parts come from the same visibility pass
+    const auto part1Time = timer.lap();
 
     return {
-        make_optional<PartialDayResult>({"Visible trees", to_string(visibleCount)}),
-        make_optional<PartialDayResult>({"Max scenic score", to_string(maxScenicScore)})
+        make_optional<PartialDayResult>({"Visible trees", to_string(visibleCount), part1Time}),
+        make_optional<PartialDayResult>({"Max scenic score", to_string(maxScenicScore), timer.lap()})
     };
 }
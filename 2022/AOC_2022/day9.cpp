@@ -4,13 +4,14 @@
 
 #include "Coords.h"
 #include "Rope.h"
+#include "VisitedBitmap.h"
 #include "printers.h"
 
 using namespace std;
 
 #include <sstream>
 
-const string to_string(const Coords& c) {
+const string to_string(const LongCoords& c) {
 	ostringstream ss;
 	ss << c;
 	return ss.str();
@@ -21,25 +22,30 @@ const string to_string(const Coords& c) {
 #include <iostream>
 #include <functional>
 
-void printState(size_t width, size_t height, const Coords& origin, const Rope& rope, const auto trailBegin, const auto trailEnd) {
+void printState(size_t width, size_t height, const LongCoords& origin, const Rope& rope, const VisitedBitmap& trail) {
 	vector<vector<char>> field(height, vector<char>(width, '.'));
 
-	const auto put = [& origin, &field](const Coords& loc, const char ch) {
-		const Coords mapped { loc.x + origin.x, -loc.y + origin.y };
+	const auto put = [& origin, &field](const LongCoords& loc, const char ch) {
+		const LongCoords mapped { loc.x + origin.x, -loc.y + origin.y };
 
 		field[mapped.y][mapped.x] = ch;
 	};
 
 	put({ 0, 0 }, 'S');
 
-	// put train
-	std::for_each(trailBegin, trailEnd, [&put](const Coords& c) {
-		put(c, '#');
-	});
+	// put trail
+	for (long long y = 0; y < static_cast<long long>(height); ++y) {
+		for (long long x = 0; x < static_cast<long long>(width); ++x) {
+			const LongCoords loc{ x - origin.x, origin.y - y };
+			if (trail.contains(loc)) {
+				put(loc, '#');
+			}
+		}
+	}
 
 	// put tail
-	for (size_t i = rope.knots.size() - 1; i > 0; --i) {
-		put(rope.knots.at(i), static_cast<char>(i + '0'));
+	for (size_t i = rope.size() - 1; i > 0; --i) {
+		put(rope.knot(i), static_cast<char>(i + '0'));
 	}
 
 	// put head
@@ -51,44 +57,136 @@ void printState(size_t width, size_t height, const Coords& origin, const Rope& r
 	});
 }
 
-#include <unordered_set>
-
-DayResult day9() {
-	const auto& lines = readFile("day_9_input.txt");
+#include <charconv>
+#include <string_view>
+#include <vector>
+#include <cstdlib>
+#include <cassert>
 
+// Both tails are tracked in the same simulation
+class RopeSimulation {
+	// The second knot of the long rope moves exactly like the tail of a two knot one
 	Rope rope{ 10, { 0, 0 } };
 
-	unordered_set<Coords, CoordsHasher> visitedByTail;
-	unordered_set<Coords, CoordsHasher> visitedByTail2;
+public:
+	static constexpr long long maxReach = 1ll << 62;
 
-	for (const auto& line : lines) {
+	VisitedBitmap visitedBySecond;
+	VisitedBitmap visitedByLast;
 
-		int multiplier = atoi(line.data() + 2);
-		//cout << "== " << line << " ==\n\n";
+	RopeSimulation() {
+		visitedBySecond.insert(rope.second());
+		visitedByLast.insert(rope.last());
+	}
 
-		while (multiplier --> 0) {
-			switch (line[0]) {
-			case 'L': rope.move(Left); break;
-			case 'R': rope.move(Right); break;
-			case 'U': rope.move(Up); break;
-			case 'D': rope.move(Down); break;
-			default:
-				throw ParsingError("Bad direction specifier");
+	void motion(const Coords& step, long long count) {
+		// Far enough from overflowing that no step of the rope does
+		const auto reach = abs(rope.first().x) + abs(rope.first().y);
+		if (count < 0 || count > maxReach - reach) {
+			throw ParsingError("Motion too long");
+		}
+
+		while (count > 0) {
+			// Straightened out behind the head, the whole rope slides along and
+			// each tail covers a run of cells: no need to step through it
+			if (count >= VisitedBitmap::minRunLength && rope.inLine(step)) {
+				const LongCoords longStep{ step.x, step.y };
+				visitedBySecond.insertRun(rope.second() + longStep, step, count);
+				visitedByLast.insertRun(rope.last() + longStep, step, count);
+				rope.advance(step, count);
+				return;
 			}
 
-			visitedByTail.insert(rope.second());
-			visitedByTail2.insert(rope.last());
-			//printState(6, 5, { 0, 4 }, rope, visitedByTail2.cbegin(), visitedByTail2.cend());
+			--count;
+			const auto moved = rope.move(step);
+			if (moved > 1) {
+				visitedBySecond.insert(rope.second());
+			}
+			if (moved == rope.size()) {
+				visitedByLast.insert(rope.last());
+			}
+			//printState(6, 5, { 0, 4 }, rope, visitedByLast);
 			//cout << endl;
 		}
+	}
+};
+
+// Alternating right and up motions of the same length, the tails spread along a
+// diagonal. The visited cells have to fit in memory however far it goes.
+pair<size_t, size_t> staircaseVisits(int motions, long long length) {
+	RopeSimulation simulation;
+	for (int i = 0; i < motions; ++i) {
+		simulation.motion(i % 2 == 0 ? Right : Up, length);
+	}
+	return { simulation.visitedBySecond.size(), simulation.visitedByLast.size() };
+}
 
-		//printState(27, 21, { 11, 15 }, rope, visitedByTail2.cbegin(), visitedByTail2.cend());
-		//cout << endl;
+// "<direction> <count>"
+pair<Coords, long long> parseMotion(const string_view line) {
+	long long count = 0;
+	if (line.size() < 3 || from_chars(line.data() + 2, line.data() + line.size(), count).ec != errc()) {
+		throw ParsingError("Bad motion: " + string(line));
 	}
 
+	switch (line[0]) {
+	case 'L': return { Left, count };
+	case 'R': return { Right, count };
+	case 'U': return { Up, count };
+	case 'D': return { Down, count };
+	default:
+		throw ParsingError("Bad direction specifier");
+	}
+}
+
+// Cells visited by the second knot and by the tail of the long rope
+template <typename TLines>
+pair<size_t, size_t> visits(const TLines& lines) {
+	RopeSimulation simulation;
+	for (const string_view line : lines) {
+		//cout << "== " << line << " ==\n\n";
+		const auto [step, count] = parseMotion(line);
+		simulation.motion(step, count);
+	}
+	return { simulation.visitedBySecond.size(), simulation.visitedByLast.size() };
+}
+
+bool day9SelfCheck() {
+	const struct {
+		int motions;
+		long long length;
+		pair<size_t, size_t> expected;
+	} staircases[]{
+		// Without runs, with runs for most of each motion, and far beyond int
+		{ 10000, 50, { 490001, 410001 } },
+		{ 10000, 100, { 990001, 910001 } },
+		{ 20, 3'000'000'000, { 59'999'999'981, 59'999'999'821 } },
+	};
+
+	bool passed = true;
+	for (const auto& [motions, length, expected] : staircases) {
+		if (const auto result = staircaseVisits(motions, length); result != expected) {
+			cerr << "Day 9 staircase of " << motions << " motions of " << length << ": visited "
+				<< result.first << " and " << result.second << " instead of " << expected.first << " and " << expected.second << endl;
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+DayResult day9() {
+	assert((visits(vector<string_view>{ "R 4", "U 4", "L 3", "D 1", "R 4", "D 1", "L 5", "R 2" }) == pair<size_t, size_t>{ 13, 1 }));
+	assert((visits(vector<string_view>{ "R 5", "U 8", "L 8", "D 3", "R 17", "D 10", "L 25", "U 20" }) == pair<size_t, size_t>{ 88, 36 }));
+	// Long enough for runs
+	assert((visits(vector<string_view>{ "R 100", "U 100", "L 200", "D 300" }) == pair<size_t, size_t>{ 697, 665 }));
+
+	PartTimer timer;
+	const LineView lines("day_9_input.txt");
+
+	const auto [visitedBySecond, visitedByLast] = visits(lines);
+	const auto part1Time = timer.lap();
 
 	return {
-		make_optional<PartialDayResult>({"Visited by small tail", to_string(visitedByTail.size())}),
-		make_optional<PartialDayResult>({"visited by full tail", to_string(visitedByTail2.size())}),
+		make_optional<PartialDayResult>({"Visited by small tail", to_string(visitedBySecond), part1Time}),
+		make_optional<PartialDayResult>({"visited by full tail", to_string(visitedByLast), timer.lap()}),
 	};
 }
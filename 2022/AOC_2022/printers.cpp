@@ -1,4 +1,4 @@
-#include "TaggedStack.h"
+#include "CrateStacks.h"
 
 #include "printers.h"
 
@@ -9,74 +9,38 @@
 
 using namespace std;
 
-ostream& operator<< (ostream& os, const TaggedStack& tq) {
-    return os << "{[" << tq.tag << "]: " << tq.stack << "}";
+ostream& operator<< (ostream& os, const CrateStack& stack) {
+    return os << "{" << stack.contents() << "}";
 }
 
-ostream& operator<<(ostream& os, const Grid& g) {
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(2) << current.treeSize;
-
-        if (loc.x + 1 == g.n) {
-            cout << endl;
-        }
-    });
-
-    cout << endl;
-
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << ' ' << (current.isVisible ? "." : " ");
-
-        if (loc.x + 1 == g.n) {
-            cout << endl;
-        }
-    });
-    cout << endl;
-
-    cout << "ViewDistanceLeft" << endl;
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(3) << current.viewDistanceLeft;
-
-        if (loc.x + 1 == g.n) {
-            cout << endl;
-        }
-    });
-
-    cout << "ViewDistanceRight" << endl;
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(3) << current.viewDistanceRight;
-
-        if (loc.x + 1 == g.n) {
-            cout << endl;
-        }
-    });
-
-    cout << "ViewDistanceUp" << endl;
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(3) << current.viewDistanceUp;
+ostream& operator<< (ostream& os, const ChunkedCrateStack& stack) {
+    return os << "{" << stack.contents() << "}";
+}
 
-        if (loc.x + 1 == g.n) {
-            cout << endl;
+ostream& operator<<(ostream& os, const Grid& g) {
+    for (size_t y = 0; y < g.height; ++y) {
+        for (size_t x = 0; x < g.width; ++x) {
+            os << setw(2) << static_cast<int>(g.at({ x, y }));
         }
-    });
-
-    cout << "viewDistanceDown" << endl;
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(3) << current.viewDistanceDown;
+        os << endl;
+    }
+    os << endl;
 
-        if (loc.x + 1 == g.n) {
-            cout << endl;
+    for (size_t y = 0; y < g.height; ++y) {
+        for (size_t x = 0; x < g.width; ++x) {
+            os << ' ' << (g.isVisible({ x, y }) ? "." : " ");
         }
-    });
-
-    cout << "Scenic score" << endl;
-    g.visitTopDownLeftRight([&g](const SizePoint& loc, const Grid::Location& current) {
-        cout << setw(3) << current.scenicScore;
-
-        if (loc.x + 1 == g.n) {
-            cout << endl;
+        os << endl;
+    }
+    os << endl;
+
+    os << "Scenic score" << endl;
+    for (size_t y = 0; y < g.height; ++y) {
+        for (size_t x = 0; x < g.width; ++x) {
+            os << setw(3) << g.scenicScore({ x, y });
         }
-    });
+        os << endl;
+    }
 
     return os;
 }
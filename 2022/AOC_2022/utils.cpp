@@ -1,11 +1,32 @@
 #include "utils.h"
 
+#include "../../common/LineSplit.h"
+
 #include <fstream>
 #include <string>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#endif
 
 using namespace std;
 
+static thread_local chrono::nanoseconds readFileTotal{};
+
 vector<string> readFile(string path) {
+    const auto start = chrono::steady_clock::now();
     vector<string> data;
     ifstream infile(path);
     if (!infile) {
@@ -17,5 +38,127 @@ vector<string> readFile(string path) {
         data.push_back(str);
     }
 
+    readFileTotal += chrono::steady_clock::now() - start;
     return data;
-}
\ No newline at end of file
+}
+
+LineView::LineView(const string& path) {
+    const auto start = chrono::steady_clock::now();
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw runtime_error("Couldn't open " + path);
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw runtime_error("Couldn't get the size of " + path);
+    }
+
+    // A file mapping can't be empty
+    if (fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        CloseHandle(file);
+        if (!view) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            throw runtime_error("Couldn't map " + path);
+        }
+        data = static_cast<const char*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+    }
+    else {
+        CloseHandle(file);
+    }
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Couldn't open " + path);
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw runtime_error("Couldn't get the size of " + path);
+    }
+
+    // An empty mapping is invalid
+    if (info.st_size > 0) {
+        void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw runtime_error("Couldn't map " + path);
+        }
+        madvise(address, info.st_size, MADV_SEQUENTIAL);
+        mapping = address;
+        data = static_cast<const char*>(address);
+        length = static_cast<size_t>(info.st_size);
+    }
+    else {
+        close(fd);
+    }
+#endif
+
+    lines = splitLines(data, length);
+
+    readFileTotal += chrono::steady_clock::now() - start;
+}
+
+LineView::~LineView() {
+    if (!mapping) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(mapping, length);
+#endif
+}
+
+chrono::nanoseconds readFileTime() {
+    return readFileTotal;
+}
+
+ReadTimer::ReadTimer()
+    : start(chrono::steady_clock::now())
+{
+}
+
+ReadTimer::~ReadTimer() {
+    readFileTotal += chrono::steady_clock::now() - start;
+}
+
+chrono::nanoseconds processCpuTime() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        throw runtime_error("Couldn't get the process times");
+    }
+    // In units of 100 ns
+    const auto ticks = [](const FILETIME& time) {
+        return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return chrono::nanoseconds{ (ticks(kernel) + ticks(user)) * 100 };
+#else
+    timespec time{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+        throw runtime_error("Couldn't get the process CPU time");
+    }
+    return chrono::seconds{ time.tv_sec } + chrono::nanoseconds{ time.tv_nsec };
+#endif
+}
+
+static atomic<unsigned> concurrentDays{ 1 };
+
+unsigned dayThreads() {
+    return max(1u, thread::hardware_concurrency() / concurrentDays);
+}
+
+void setConcurrentDays(unsigned days) {
+    concurrentDays = max(1u, days);
+}
@@ -3,7 +3,63 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <chrono>
+#include <cstddef>
 
 std::vector<std::string> readFile(std::string path);
 
+// The lines of a memory mapped file, as views over the mapping instead of copies.
+// The views are valid for as long as the LineView lives.
+class LineView {
+    const char* data = nullptr;
+    std::size_t length = 0;
+    void* mapping = nullptr;
+    std::vector<std::string_view> lines;
+
+public:
+    using const_iterator = std::vector<std::string_view>::const_iterator;
+
+    explicit LineView(const std::string& path);
+    ~LineView();
+
+    LineView(const LineView&) = delete;
+    LineView& operator=(const LineView&) = delete;
+
+    const_iterator begin() const { return lines.begin(); }
+    const_iterator end() const { return lines.end(); }
+    std::size_t size() const { return lines.size(); }
+    bool empty() const { return lines.empty(); }
+    std::string_view operator[](std::size_t index) const { return lines[index]; }
+    std::string_view at(std::size_t index) const { return lines.at(index); }
+
+    // The whole file
+    std::string_view contents() const { return { data, length }; }
+};
+
+// Total time the calling thread has spent in readFile, in loading LineViews
+// and under ReadTimers
+std::chrono::nanoseconds readFileTime();
+
+// Adds its lifetime to readFileTime(), for the days that read their input
+// through their own streams
+class ReadTimer {
+    const std::chrono::steady_clock::time_point start;
+
+public:
+    ReadTimer();
+    ~ReadTimer();
+
+    ReadTimer(const ReadTimer&) = delete;
+    ReadTimer& operator=(const ReadTimer&) = delete;
+};
+
+// CPU time of the whole process so far, all its threads included
+std::chrono::nanoseconds processCpuTime();
+
+// Threads a day may start for itself. While the runner has several days going
+// at once they share the cores, so together they don't oversubscribe them.
+unsigned dayThreads();
+void setConcurrentDays(unsigned days);
+
 #endif // !_utils_h_
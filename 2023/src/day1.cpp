@@ -26,11 +26,11 @@ const vector<string> wordDigits {
     "nine"
 };
 
-long first(const vector<string> input) {
+long first(const auto& input) {
     // print(input, "input");
 
     vector<pair<char, char>> pairs;
-    transform(begin(input), end(input), back_inserter(pairs), [](const string& line) {
+    transform(begin(input), end(input), back_inserter(pairs), [](const string_view line) {
         const auto first = line.find_first_of(digits);
         const auto last = line.find_last_of(digits);
         return make_pair(line[first], line[last]);
@@ -99,7 +99,7 @@ const FoundNumber& selectLastNumber(const FoundNumber& lhs, const FoundNumber& r
     return rhs;
 }
 
-long second(const vector<string>& input) {
+long second(const auto& input) {
     // print(input);
 
     vector<pair<FoundNumber, FoundNumber>> pairs;
@@ -108,7 +108,7 @@ long second(const vector<string>& input) {
         begin(input),
         end(input),
         back_inserter(pairs),
-        [](const string& line) {
+        [](const string_view line) {
             const auto firstDigitPos = line.find_first_of(digits);
             const FoundNumber firstDigit {
                 firstDigitPos,
@@ -189,7 +189,7 @@ int main(const int, const char * const []) {
     assertEquals(142, first_test_result);
     std::cout << "Test ok" << endl;
 
-    const auto input = utils::readFile("input/day1");
+    const utils::LineView input("input/day1");
     // print(input);
 
     const auto first_result = first(input);
@@ -16,9 +16,18 @@
 #include <iterator>
 #include <ranges>
 #include <charconv>
+#include <string_view>
+#include <bit>
 
 #include <cstdlib>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../common/LineSplit.h"
+
 void assertEquals(const auto& expected, const auto& actual, const std::optional<std::string> message = std::nullopt) {
     if(expected != actual) {
         std::cerr << "Expected: " << expected << "\n" << "Actual: " << actual << std::endl;
@@ -61,6 +70,64 @@ namespace utils {
         return data;
     }
 
+    // The lines of a memory mapped file, as views over the mapping instead of copies.
+    // The views are valid for as long as the LineView lives.
+    class LineView {
+        const char* data = nullptr;
+        size_t length = 0;
+        vector<string_view> lines;
+
+    public:
+        using const_iterator = vector<string_view>::const_iterator;
+
+        explicit LineView(const string& path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if(fd < 0) {
+                throw runtime_error("Couldn't open " + path);
+            }
+
+            struct stat info{};
+            if(fstat(fd, &info) != 0) {
+                close(fd);
+                throw runtime_error("Couldn't get the size of " + path);
+            }
+
+            // An empty mapping is invalid
+            if(info.st_size > 0) {
+                void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(address == MAP_FAILED) {
+                    close(fd);
+                    throw runtime_error("Couldn't map " + path);
+                }
+                madvise(address, info.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+                length = static_cast<size_t>(info.st_size);
+            }
+            close(fd);
+
+            lines = ::splitLines(data, length);
+        }
+
+        ~LineView() {
+            if(data != nullptr) {
+                munmap(const_cast<char*>(data), length);
+            }
+        }
+
+        LineView(const LineView&) = delete;
+        LineView& operator=(const LineView&) = delete;
+
+        const_iterator begin() const { return lines.begin(); }
+        const_iterator end() const { return lines.end(); }
+        size_t size() const { return lines.size(); }
+        bool empty() const { return lines.empty(); }
+        string_view operator[](const size_t index) const { return lines[index]; }
+        string_view at(const size_t index) const { return lines.at(index); }
+
+        // The whole file
+        string_view contents() const { return {data, length}; }
+    };
+
     vector<string> split(const string& str, const char& delimeter = '\n')
     {
         auto result = vector<string>{};
@@ -0,0 +1,111 @@
+#ifndef BucketQueue_h_
+#define BucketQueue_h_
+
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <cstddef>
+
+// Monotone priority queue for small integer priorities (Dial's algorithm).
+//
+// The priorities in the queue always lie in [p, p + maxStep], where p is the
+// last popped priority, which holds for a shortest path search whose edges cost
+// at most maxStep. That range is covered by maxStep + 1 buckets used as a ring,
+// so push is O(1) and pop is O(1) amortized over the scan of the ring.
+//
+// There's no decrease-key: the node is pushed again with its new priority and
+// the outdated entry is dropped when pop reaches it, see pop(isStale).
+// Only needs the standard library, so the solvers of every year can include it.
+template <typename TNode, typename TPriority = unsigned>
+class BucketQueue {
+    static_assert(std::is_integral_v<TPriority>, "The priorities index the buckets");
+
+public:
+    struct Entry {
+        TNode node;
+        TPriority priority;
+    };
+
+private:
+    std::vector<std::vector<Entry>> buckets;
+    TPriority current{};
+    std::size_t count = 0;
+
+    std::vector<Entry>& bucket(TPriority priority) {
+        return buckets[static_cast<std::size_t>(priority) % buckets.size()];
+    }
+
+public:
+    explicit BucketQueue(TPriority maxStep, TPriority first = {})
+        : buckets{}
+        , current(first)
+    {
+        if constexpr (std::is_signed_v<TPriority>) {
+            if (maxStep < 0) {
+                throw std::invalid_argument("The step between priorities can't be negative");
+            }
+        }
+        buckets.resize(static_cast<std::size_t>(maxStep) + 1);
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Counts the stale entries too
+    std::size_t size() const {
+        return count;
+    }
+
+    // The lowest priority that may still be in the queue
+    TPriority lowestPriority() const {
+        return current;
+    }
+
+    void push(TNode node, TPriority priority) {
+        if (priority < current || static_cast<std::size_t>(priority - current) >= buckets.size()) {
+            throw std::out_of_range("Priority outside of the queue's window");
+        }
+
+        bucket(priority).push_back({ std::move(node), priority });
+        ++count;
+    }
+
+    // Pops an entry of the lowest priority, skipping the entries for which
+    // isStale(entry) is true (e.g. the node was reached cheaper since)
+    template <typename TIsStale>
+    std::optional<Entry> pop(TIsStale isStale) {
+        while (count > 0) {
+            auto& entries = bucket(current);
+            if (entries.empty()) {
+                ++current;
+                continue;
+            }
+
+            Entry entry = std::move(entries.back());
+            entries.pop_back();
+            --count;
+
+            if (!isStale(entry)) {
+                return entry;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<Entry> pop() {
+        return pop([](const Entry&) { return false; });
+    }
+
+    void clear(TPriority first = {}) {
+        for (auto& entries : buckets) {
+            entries.clear();
+        }
+        current = first;
+        count = 0;
+    }
+};
+
+#endif // !BucketQueue_h_
@@ -0,0 +1,55 @@
+#ifndef LineSplit_h_
+#define LineSplit_h_
+
+// The line splitting of the LineViews of every year, kept in one place
+
+#include <vector>
+#include <string_view>
+#include <bit>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AOC_SSE2
+#include <emmintrin.h>
+#endif
+
+// Splits [data, data + length) on '\n' the way getline does: no empty line after
+// a final newline, and a '\r' before the newline is dropped as text mode would.
+inline std::vector<std::string_view> splitLines(const char* data, const std::size_t length) {
+    std::vector<std::string_view> lines;
+    std::size_t lineStart = 0;
+
+    const auto addLine = [&](const std::size_t newline) {
+        std::size_t lineEnd = newline;
+        if (lineEnd > lineStart && data[lineEnd - 1] == '\r') {
+            --lineEnd;
+        }
+        lines.emplace_back(data + lineStart, lineEnd - lineStart);
+        lineStart = newline + 1;
+    };
+
+    std::size_t i = 0;
+#ifdef AOC_SSE2
+    // 16 bytes per compare, then one bit per newline in the block
+    const auto newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= length; i += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline))); mask; mask &= mask - 1) {
+            addLine(i + std::countr_zero(mask));
+        }
+    }
+#endif
+    for (; i < length; ++i) {
+        if (data[i] == '\n') {
+            addLine(i);
+        }
+    }
+
+    if (lineStart < length) {
+        addLine(length);
+    }
+
+    return lines;
+}
+
+#endif // !LineSplit_h_